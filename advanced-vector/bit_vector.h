@@ -0,0 +1,588 @@
+#pragma once
+#include "vector_kernels.h"
+
+// Вектор Bits-битовых целых, упакованных в 64-битные слова Vector<uint64_t>: Vector<bool> и
+// Vector<uint8_t> с 2–4-битными кодами тратят байт на элемент, а PackedVector — ровно Bits бит.
+// Bits делит 64, поэтому элемент не переходит через границу слова. BitVector — PackedVector<1>
+// для битовых карт.
+//
+// API повторяет Vector, но operator[] и изменяемые итераторы отдают прокси-ссылку Reference, а не
+// T &. Resize, Insert и Erase сдвигают и заполняют биты словами, а не по элементу. Count и
+// FindFirst сравнивают сразу все элементы слова, а поэлементные AND/OR/XOR для BitVector
+// обрабатывают слова векторами, для чего запускаются через ядра vector_kernels.h
+//
+// Биты последнего слова за пределами Size() всегда нулевые: сравнение, Count и побитовые
+// операции работают по целым словам без маски
+
+namespace detail {
+
+template <unsigned Bits>
+using PackedValue =
+    std::conditional_t<Bits == 1, bool,
+                       std::conditional_t<Bits <= 8, uint8_t, std::conditional_t<Bits <= 16, uint16_t, uint32_t>>>;
+
+inline constexpr size_t kPackedWordBits = 64;
+
+// Слово, в каждом Bits-битовом поле которого записано value
+template <unsigned Bits>
+constexpr uint64_t BroadcastLanes(uint64_t value) noexcept {
+    return value * (~uint64_t{0} / ((uint64_t{1} << Bits) - 1));
+}
+
+// Младший бит каждого нулевого поля x. Сдвиги на 1, 2, 4, ... собирают в младший бит поля OR всех
+// его битов и не задевают соседние поля
+template <unsigned Bits>
+constexpr uint64_t ZeroLanes(uint64_t x) noexcept {
+    for (unsigned shift = 1; shift < Bits; shift <<= 1) {
+        x |= x >> shift;
+    }
+    return ~x & BroadcastLanes<Bits>(1);
+}
+
+// Маска младших count бит слова, count <= 64
+constexpr uint64_t LowBits(size_t count) noexcept {
+    return count >= kPackedWordBits ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+}
+
+// Читает count <= 64 бит, начиная с бита position
+inline uint64_t ReadBits(const uint64_t *words, size_t position, size_t count) noexcept {
+    const size_t index = position / kPackedWordBits;
+    const size_t offset = position % kPackedWordBits;
+    uint64_t bits = words[index] >> offset;
+    if (offset + count > kPackedWordBits) {
+        bits |= words[index + 1] << (kPackedWordBits - offset);
+    }
+    return bits & LowBits(count);
+}
+
+// Записывает младшие count <= 64 бит bits, начиная с бита position
+inline void WriteBits(uint64_t *words, size_t position, size_t count, uint64_t bits) noexcept {
+    const size_t index = position / kPackedWordBits;
+    const size_t offset = position % kPackedWordBits;
+    const uint64_t mask = LowBits(count);
+    bits &= mask;
+    words[index] = (words[index] & ~(mask << offset)) | (bits << offset);
+    if (offset + count > kPackedWordBits) {
+        const uint64_t high_mask = LowBits(offset + count - kPackedWordBits);
+        words[index + 1] = (words[index + 1] & ~high_mask) | (bits >> (kPackedWordBits - offset));
+    }
+}
+
+// Переносит count бит с позиции from на позицию to; диапазоны могут пересекаться. Биты идут
+// кусками по слову в ту сторону, при которой кусок не затирает ещё не прочитанные
+inline void MoveBits(uint64_t *words, size_t to, size_t from, size_t count) noexcept {
+    if (to < from) {
+        for (size_t done = 0; done < count; done += kPackedWordBits) {
+            const size_t chunk = std::min(kPackedWordBits, count - done);
+            WriteBits(words, to + done, chunk, ReadBits(words, from + done, chunk));
+        }
+    } else if (to > from) {
+        for (size_t left = count; left > 0;) {
+            const size_t chunk = std::min(kPackedWordBits, left);
+            left -= chunk;
+            WriteBits(words, to + left, chunk, ReadBits(words, from + left, chunk));
+        }
+    }
+}
+
+// Заполняет count бит с позиции position повторяющимся pattern. position должна быть кратна длине
+// периода pattern, а куски по слову сохраняют это выравнивание
+inline void FillBits(uint64_t *words, size_t position, size_t count, uint64_t pattern) noexcept {
+    for (size_t done = 0; done < count; done += kPackedWordBits) {
+        WriteBits(words, position + done, std::min(kPackedWordBits, count - done), pattern);
+    }
+}
+
+// Сколько полей n слов равны полям pattern
+template <unsigned Bits>
+[[gnu::always_inline]] inline size_t CountLanesKernel(const uint64_t *words, size_t n, uint64_t pattern) noexcept {
+    // Четыре счётчика, чтобы popcnt соседних слов не ждали друг друга
+    size_t counts[4] = {};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t j = 0; j < 4; ++j) {
+            counts[j] += std::popcount(ZeroLanes<Bits>(words[i + j] ^ pattern));
+        }
+    }
+    for (; i < n; ++i) {
+        counts[0] += std::popcount(ZeroLanes<Bits>(words[i] ^ pattern));
+    }
+    return counts[0] + counts[1] + counts[2] + counts[3];
+}
+
+enum class BitwiseOp {
+    kAnd,
+    kOr,
+    kXor,
+};
+
+// dst[i] = dst[i] kOp src[i] для n слов, по kBytes байт за шаг
+template <size_t kBytes, BitwiseOp kOp>
+[[gnu::always_inline]] inline void BitwiseKernel(uint64_t *dst, const uint64_t *src, size_t n) noexcept {
+    using V = typename SimdVec<uint64_t, kBytes>::type;
+    constexpr size_t kLanes = kBytes / sizeof(uint64_t);
+
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        V lhs;
+        V rhs;
+        SimdLoad<kBytes, false>(lhs, dst + i);
+        SimdLoad<kBytes, false>(rhs, src + i);
+        // Операция применяется прямо здесь: функция с векторами в параметрах получила бы ABI
+        // базового набора инструкций
+        if constexpr (kOp == BitwiseOp::kAnd) {
+            lhs &= rhs;
+        } else if constexpr (kOp == BitwiseOp::kOr) {
+            lhs |= rhs;
+        } else {
+            lhs ^= rhs;
+        }
+        std::memcpy(dst + i, &lhs, sizeof(V));
+    }
+    for (; i < n; ++i) {
+        if constexpr (kOp == BitwiseOp::kAnd) {
+            dst[i] &= src[i];
+        } else if constexpr (kOp == BitwiseOp::kOr) {
+            dst[i] |= src[i];
+        } else {
+            dst[i] ^= src[i];
+        }
+    }
+}
+
+}  // namespace detail
+
+template <unsigned Bits, typename Allocator = std::allocator<uint64_t>, typename GrowthPolicy = DoublingGrowth>
+class PackedVector {
+    static_assert(Bits > 0 && Bits < 64 && 64 % Bits == 0, "Bits must divide 64");
+
+    using Word = uint64_t;
+    static constexpr size_t kWordBits = detail::kPackedWordBits;
+    static constexpr size_t kPerWord = kWordBits / Bits;
+    static constexpr Word kElementMask = (Word{1} << Bits) - 1;
+
+    template <bool Const>
+    class Iterator;
+
+public:
+    using value_type = detail::PackedValue<Bits>;
+    using allocator_type = Allocator;
+
+    class Reference;
+
+    using reference = Reference;
+    using const_reference = value_type;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    PackedVector() = default;
+
+    explicit PackedVector(const Allocator &alloc) noexcept : words_(alloc) {
+    }
+
+    explicit PackedVector(size_t size, value_type value = value_type(), const Allocator &alloc = Allocator())
+        : words_(alloc) {
+        Resize(size, value);
+    }
+
+    PackedVector(std::initializer_list<value_type> values, const Allocator &alloc = Allocator()) : words_(alloc) {
+        Reserve(values.size());
+        for (const value_type value : values) {
+            PushBack(value);
+        }
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Reference(words_.Data() + index / kPerWord, index % kPerWord * Bits);
+    }
+
+    value_type operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return static_cast<value_type>((words_[index / kPerWord] >> (index % kPerWord * Bits)) & kElementMask);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return words_.Capacity() * kPerWord;
+    }
+
+    // Слова с элементами: элемент i — биты [i * Bits % 64, ...) слова i * Bits / 64
+    std::span<const Word> Words() const noexcept {
+        return {words_.Data(), words_.Size()};
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    void Swap(PackedVector &other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        words_.Reserve(WordsFor(new_capacity));
+    }
+
+    void Clear(bool release_memory = false) noexcept {
+        words_.Clear(release_memory);
+        size_ = 0;
+    }
+
+    // Новые элементы, сколько бы их ни было, заполняются словами. Вместимость растёт по
+    // GrowthPolicy, как у Vector при вставке, поэтому Insert и Resize по одному элементу
+    // амортизированы
+    void Resize(size_t new_size, value_type value = value_type()) {
+        if (new_size < size_) {
+            words_.Resize(WordsFor(new_size));
+            ClearUnused(new_size);
+        } else if (new_size > size_) {
+            const size_t new_words = WordsFor(new_size);
+            if (new_words > words_.Capacity()) {
+                words_.Reserve(GrowthPolicy::template NextCapacity<Word>(words_.Capacity(), new_words));
+            }
+            words_.Resize(new_words);
+            if (value != value_type()) {
+                FillElements(size_, new_size - size_, value);
+            }
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(value_type value) {
+        if (size_ % kPerWord == 0) {
+            words_.PushBack(0);
+        }
+        ++size_;
+        (*this)[size_ - 1] = value;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        (*this)[size_ - 1] = value_type();
+        --size_;
+        if (size_ % kPerWord == 0) {
+            words_.PopBack();
+        }
+    }
+
+    iterator Insert(const_iterator pos, value_type value) {
+        return Insert(pos, 1, value);
+    }
+
+    // Хвост сдвигается на count элементов словами, а не по элементу
+    iterator Insert(const_iterator pos, size_t count, value_type value) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        const size_t old_size = size_;
+        Resize(size_ + count);
+        detail::MoveBits(words_.Data(), (index + count) * Bits, index * Bits, (old_size - index) * Bits);
+        FillElements(index, count, value);
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) noexcept {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) noexcept {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+        detail::MoveBits(words_.Data(), index * Bits, (index + count) * Bits, (size_ - index - count) * Bits);
+        words_.Resize(WordsFor(size_ - count));
+        size_ -= count;
+        ClearUnused(size_);
+        return begin() + index;
+    }
+
+    // Количество элементов, равных value
+    size_t Count(value_type value) const noexcept {
+        const Word pattern = detail::BroadcastLanes<Bits>(static_cast<Word>(value));
+        const Word *words = words_.Data();
+        const size_t full_words = size_ / kPerWord;
+        size_t count = detail::Dispatch<1>([&](auto, auto) __attribute__((always_inline)) {
+            return detail::CountLanesKernel<Bits>(words, full_words, pattern);
+        });
+        if (const size_t tail = size_ % kPerWord; tail != 0) {
+            const Word matches = detail::ZeroLanes<Bits>(words[full_words] ^ pattern);
+            count += std::popcount(matches & detail::LowBits(tail * Bits));
+        }
+        return count;
+    }
+
+    // Количество единичных битов
+    size_t Count() const noexcept
+        requires(Bits == 1)
+    {
+        return Count(true);
+    }
+
+    // Индекс первого элемента, равного value, начиная с from, или Size()
+    size_t FindFirst(value_type value, size_t from = 0) const noexcept {
+        if (from >= size_) {
+            return size_;
+        }
+        const Word pattern = detail::BroadcastLanes<Bits>(static_cast<Word>(value));
+        // Поля до from в первом слове отбрасываются маской
+        Word skip = ~detail::LowBits(from % kPerWord * Bits);
+        for (size_t i = from / kPerWord; i < words_.Size(); ++i) {
+            if (const Word matches = detail::ZeroLanes<Bits>(words_[i] ^ pattern) & skip; matches != 0) {
+                return std::min(size_, i * kPerWord + std::countr_zero(matches) / Bits);
+            }
+            skip = ~Word{0};
+        }
+        return size_;
+    }
+
+    // Индекс первого единичного бита или Size()
+    size_t FindFirst() const noexcept
+        requires(Bits == 1)
+    {
+        return FindFirst(true);
+    }
+
+    // Поэлементные операции над битовыми картами одного размера
+    PackedVector &operator&=(const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return ApplyWords<detail::BitwiseOp::kAnd>(rhs);
+    }
+
+    PackedVector &operator|=(const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return ApplyWords<detail::BitwiseOp::kOr>(rhs);
+    }
+
+    PackedVector &operator^=(const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return ApplyWords<detail::BitwiseOp::kXor>(rhs);
+    }
+
+    friend PackedVector operator&(PackedVector lhs, const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return lhs &= rhs;
+    }
+
+    friend PackedVector operator|(PackedVector lhs, const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return lhs |= rhs;
+    }
+
+    friend PackedVector operator^(PackedVector lhs, const PackedVector &rhs) noexcept
+        requires(Bits == 1)
+    {
+        return lhs ^= rhs;
+    }
+
+    // Инвертирует все биты
+    void Flip() noexcept
+        requires(Bits == 1)
+    {
+        for (Word &word : words_) {
+            word = ~word;
+        }
+        ClearUnused(size_);
+    }
+
+    friend bool operator==(const PackedVector &lhs, const PackedVector &rhs) noexcept {
+        return lhs.size_ == rhs.size_ && std::equal(lhs.words_.begin(), lhs.words_.end(), rhs.words_.begin());
+    }
+
+private:
+    Vector<Word, Allocator, GrowthPolicy> words_;
+    size_t size_ = 0;
+
+    static size_t WordsFor(size_t size) noexcept {
+        return (size + kPerWord - 1) / kPerWord;
+    }
+
+    // Обнуляет биты последнего слова за элементом size - 1
+    void ClearUnused(size_t size) noexcept {
+        if (const size_t tail = size % kPerWord; tail != 0) {
+            words_[size / kPerWord] &= detail::LowBits(tail * Bits);
+        }
+    }
+
+    void FillElements(size_t index, size_t count, value_type value) noexcept {
+        detail::FillBits(words_.Data(), index * Bits, count * Bits,
+                         detail::BroadcastLanes<Bits>(static_cast<Word>(value)));
+    }
+
+    template <detail::BitwiseOp kOp>
+    PackedVector &ApplyWords(const PackedVector &rhs) noexcept {
+        assert(size_ == rhs.size_);
+        Word *dst = words_.Data();
+        const Word *src = rhs.words_.Data();
+        const size_t n = words_.Size();
+        detail::Dispatch<1>([&](auto width, auto) __attribute__((always_inline)) {
+            detail::BitwiseKernel<decltype(width)::value, kOp>(dst, src, n);
+        });
+        return *this;
+    }
+};
+
+using BitVector = PackedVector<1>;
+
+// Прокси-ссылка на элемент: читает и пишет его поле в слове
+template <unsigned Bits, typename Allocator, typename GrowthPolicy>
+class PackedVector<Bits, Allocator, GrowthPolicy>::Reference {
+public:
+    Reference(const Reference &) = default;
+
+    operator value_type() const noexcept {
+        return static_cast<value_type>((*word_ >> shift_) & kElementMask);
+    }
+
+    // Присваивание пишет в элемент, а не перенаправляет ссылку
+    Reference &operator=(value_type value) noexcept {
+        assert(static_cast<Word>(value) <= kElementMask);
+        *word_ = (*word_ & ~(kElementMask << shift_)) | (static_cast<Word>(value) << shift_);
+        return *this;
+    }
+
+    Reference &operator=(const Reference &other) noexcept {
+        return *this = static_cast<value_type>(other);
+    }
+
+    friend void swap(Reference lhs, Reference rhs) noexcept {
+        const value_type value = lhs;
+        lhs = static_cast<value_type>(rhs);
+        rhs = value;
+    }
+
+private:
+    friend class PackedVector;
+
+    Word *word_;
+    unsigned shift_;
+
+    Reference(Word *word, unsigned shift) noexcept : word_(word), shift_(shift) {
+    }
+};
+
+template <unsigned Bits, typename Allocator, typename GrowthPolicy>
+template <bool Const>
+class PackedVector<Bits, Allocator, GrowthPolicy>::Iterator {
+    using Owner = std::conditional_t<Const, const PackedVector, PackedVector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = PackedVector::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<Const, value_type, Reference>;
+
+    Iterator() = default;
+
+    Iterator(Owner *owner, size_t index) noexcept : owner_(owner), index_(index) {
+    }
+
+    // Изменяемый итератор приводится к константному
+    operator Iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return {owner_, index_};
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return (*owner_)[index_ + n];
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        Iterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        Iterator old = *this;
+        --index_;
+        return old;
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Owner *owner_ = nullptr;
+    size_t index_ = 0;
+};
@@ -0,0 +1,188 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Вектор только для добавления, в который EmplaceBack могут вызывать несколько потоков сразу без
+// блокировок. Индекс резервируется атомарным счётчиком, память растёт цепочкой сегментов
+// вместимостью kFirstSegment, 2 * kFirstSegment, 4 * kFirstSegment, ..., поэтому элементы никогда
+// не переезжают: ссылки на них стабильны, а чтение по индексу не ждёт писателей.
+//
+// Исключения ведут себя как в Vector::EmplaceBack: если конструктор T бросил, вектор не получает
+// элемента. Но зарезервированный индекс уже не вернуть, и на его месте остаётся дыра: TryGet
+// возвращает для неё nullptr, а ForEach её пропускает
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+public:
+    using allocator_type = Allocator;
+
+    static constexpr size_t kFirstSegment = 32;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator &alloc) noexcept : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector &) = delete;
+    ConcurrentVector &operator=(const ConcurrentVector &) = delete;
+
+    // Разрушение не должно пересекаться с добавлениями
+    ~ConcurrentVector() {
+        for (auto &slot : segments_) {
+            Segment *segment = slot.load(std::memory_order_acquire);
+            // Сегменты создаются не строго по порядку, так что дальше могут быть и непустые
+            if (segment == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < segment->elements.Capacity(); ++i) {
+                if (segment->ready[i].load(std::memory_order_relaxed)) {
+                    std::destroy_at(segment->elements + i);
+                }
+            }
+            delete segment;
+        }
+    }
+
+    // Количество зарезервированных индексов. Элементы с меньшими индексами могут ещё строиться
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Строит элемент в следующем свободном индексе и возвращает ссылку на него. Ссылка остаётся
+    // действительной до разрушения вектора
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        const auto [segment_index, offset] = Locate(index);
+        Segment &segment = GetOrCreateSegment(segment_index);
+
+        T *slot = std::construct_at(segment.elements + offset, std::forward<Args>(args)...);
+        segment.ready[offset].store(true, std::memory_order_release);
+        // Следующий сегмент готовит тот, кто дошёл до середины текущего, пока остальные пишут в
+        // текущий: к его концу сегмент обычно уже есть, и гонки за его создание не возникает
+        if (offset == segment.elements.Capacity() / 2 && segment_index + 1 < kMaxSegments) {
+            PrepareSegment(segment_index + 1);
+        }
+        return *slot;
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Заранее выделяет сегменты под capacity элементов, чтобы EmplaceBack не обращался к аллокатору
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        const size_t last_segment = Locate(capacity - 1).first;
+        for (size_t s = 0; s <= last_segment; ++s) {
+            GetOrCreateSegment(s);
+        }
+    }
+
+    // Элемент index, если он уже построен, иначе nullptr. Не ждёт и не блокирует
+    const T *TryGet(size_t index) const noexcept {
+        return const_cast<ConcurrentVector &>(*this).TryGet(index);
+    }
+
+    T *TryGet(size_t index) noexcept {
+        if (index >= Size()) {
+            return nullptr;
+        }
+        const auto [segment_index, offset] = Locate(index);
+        Segment *segment = segments_[segment_index].load(std::memory_order_acquire);
+        if (segment == nullptr || !segment->ready[offset].load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return segment->elements + offset;
+    }
+
+    // index должен принадлежать элементу, построение которого этот поток уже видел: например,
+    // его вернул EmplaceBack или до него дошёл ForEach
+    const T &operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept {
+        assert(index < Size());
+        const auto [segment_index, offset] = Locate(index);
+        Segment *segment = segments_[segment_index].load(std::memory_order_acquire);
+        assert(segment != nullptr && segment->ready[offset].load(std::memory_order_relaxed));
+        return segment->elements[offset];
+    }
+
+    // Вызывает f(index, element) для всех уже построенных элементов по возрастанию индекса
+    template <typename F>
+    void ForEach(F &&f) const {
+        const size_t size = Size();
+        for (size_t index = 0; index < size; ++index) {
+            if (const T *element = TryGet(index)) {
+                std::invoke(f, index, *element);
+            }
+        }
+    }
+
+private:
+    struct Segment {
+        Segment(size_t capacity, const Allocator &alloc)
+            : elements(capacity, alloc), ready(std::make_unique<std::atomic<bool>[]>(capacity)) {
+        }
+
+        RawMemory<T, Allocator> elements;
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+    // Последний сегмент занимает половину адресного пространства: больше не понадобится
+    static constexpr size_t kMaxSegments = std::numeric_limits<size_t>::digits - std::countr_zero(kFirstSegment);
+
+    static_assert(std::has_single_bit(kFirstSegment));
+
+    [[no_unique_address]] Allocator alloc_;
+    std::atomic<size_t> size_{0};
+    std::atomic<Segment *> segments_[kMaxSegments] = {};
+
+    // Сегмент s начинается с индекса kFirstSegment * (2^s - 1)
+    static std::pair<size_t, size_t> Locate(size_t index) noexcept {
+        const size_t segment = std::bit_width(index / kFirstSegment + 1) - 1;
+        return {segment, index - kFirstSegment * ((size_t{1} << segment) - 1)};
+    }
+
+    // Сегмент создают все потоки, которым он понадобился; публикуется тот, кто успел первым,
+    // остальные освобождают свой. Так добавление никогда не ждёт другой поток. Лишние выделения
+    // редки: сегмент почти всегда заранее создаёт PrepareSegment
+    Segment &GetOrCreateSegment(size_t index) {
+        assert(index < kMaxSegments);
+        Segment *segment = segments_[index].load(std::memory_order_acquire);
+        if (segment != nullptr) {
+            return *segment;
+        }
+
+        auto fresh = std::make_unique<Segment>(kFirstSegment << index, alloc_);
+        if (segments_[index].compare_exchange_strong(segment, fresh.get(), std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+            return *fresh.release();
+        }
+        return *segment;
+    }
+
+    // Создаёт сегмент заранее, если его ещё нет. Нехватка памяти здесь не мешает добавлению:
+    // сегмент создаст тот, кому он понадобится
+    void PrepareSegment(size_t index) noexcept {
+        if (segments_[index].load(std::memory_order_relaxed) != nullptr) {
+            return;
+        }
+        try {
+            GetOrCreateSegment(index);
+        } catch (...) {
+        }
+    }
+};
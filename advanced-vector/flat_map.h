@@ -0,0 +1,490 @@
+#pragma once
+#include "flat_set.h"
+
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+// Упорядоченный словарь на двух параллельных Vector: ключи отдельно от значений, так что поиск
+// читает только плотный массив ключей, а значения трогаются лишь у найденного. Итератор отдаёт
+// прокси-ссылку std::pair<const K &, V &>, которую удобно разбирать структурной привязкой.
+// Как и FlatSet, лучше подходит для таблиц, которые наполняются пачками через InsertRange или
+// конструктор, чем для частых одиночных вставок
+template <typename K, typename V, typename Compare = std::less<K>, typename KeyAllocator = std::allocator<K>,
+          typename ValueAllocator = std::allocator<V>, typename Search = BinarySearch>
+class FlatMap {
+    using Index = typename Search::template Index<K, Compare>;
+
+    template <bool Const>
+    class Iterator;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using key_compare = Compare;
+    using value_type = std::pair<K, V>;
+    using reference = std::pair<const K &, V &>;
+    using const_reference = std::pair<const K &, const V &>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, Size()};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, Size()};
+    }
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare &comp) : comp_(comp) {
+    }
+
+    // keys[i] соответствует values[i]. Пары сортируются по ключу, из эквивалентных остаётся первая
+    FlatMap(Vector<K, KeyAllocator> keys, Vector<V, ValueAllocator> values, const Compare &comp = Compare())
+        : comp_(comp), keys_(std::move(keys)), values_(std::move(values)) {
+        assert(keys_.Size() == values_.Size());
+        SortAndMerge(0, false);
+    }
+
+    FlatMap(sorted_unique_t, Vector<K, KeyAllocator> keys, Vector<V, ValueAllocator> values,
+            const Compare &comp = Compare())
+        : comp_(comp), keys_(std::move(keys)), values_(std::move(values)) {
+        assert(keys_.Size() == values_.Size());
+        assert(IsSortedUnique(0));
+        index_.Rebuild(keys_);
+    }
+
+    FlatMap(std::initializer_list<value_type> items, const Compare &comp = Compare()) : comp_(comp) {
+        InsertRange(items.begin(), items.end());
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    // Ключи по возрастанию одним массивом
+    std::span<const K> Keys() const noexcept {
+        return {keys_.Data(), keys_.Size()};
+    }
+
+    // Значения в порядке ключей
+    std::span<V> Values() noexcept {
+        return {values_.Data(), values_.Size()};
+    }
+
+    std::span<const V> Values() const noexcept {
+        return {values_.Data(), values_.Size()};
+    }
+
+    key_compare KeyComp() const {
+        return comp_;
+    }
+
+    void Swap(FlatMap &other) noexcept {
+        using std::swap;
+        swap(comp_, other.comp_);
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        swap(index_, other.index_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+        index_.Rebuild(keys_);
+    }
+
+    // Первая пара с ключом, не меньшим key
+    iterator LowerBound(const K &key) {
+        return begin() + index_.LowerBound(keys_, key, comp_);
+    }
+
+    const_iterator LowerBound(const K &key) const {
+        return begin() + index_.LowerBound(keys_, key, comp_);
+    }
+
+    iterator Find(const K &key) {
+        return begin() + FindIndex(key);
+    }
+
+    const_iterator Find(const K &key) const {
+        return begin() + FindIndex(key);
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    iterator Find(const Key &key) {
+        return begin() + FindIndex(key);
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    const_iterator Find(const Key &key) const {
+        return begin() + FindIndex(key);
+    }
+
+    bool Contains(const K &key) const {
+        return FindIndex(key) != Size();
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    bool Contains(const Key &key) const {
+        return FindIndex(key) != Size();
+    }
+
+    // Значение по ключу или nullptr, если ключа нет
+    V *TryGet(const K &key) {
+        const size_t index = FindIndex(key);
+        return index != Size() ? &values_[index] : nullptr;
+    }
+
+    const V *TryGet(const K &key) const {
+        return const_cast<FlatMap &>(*this).TryGet(key);
+    }
+
+    // Значение по ключу. Если ключа нет, бросает std::out_of_range
+    V &At(const K &key) {
+        if (V *value = TryGet(key)) {
+            return *value;
+        }
+        throw std::out_of_range("FlatMap::At: key not found");
+    }
+
+    const V &At(const K &key) const {
+        return const_cast<FlatMap &>(*this).At(key);
+    }
+
+    // Вставляет пару, если ключа ещё нет; иначе ничего не делает. Возвращает позицию пары с этим
+    // ключом и признак вставки
+    std::pair<iterator, bool> Insert(const K &key, const V &value) {
+        return TryEmplace(key, value);
+    }
+
+    std::pair<iterator, bool> Insert(K &&key, V &&value) {
+        return TryEmplace(std::move(key), std::move(value));
+    }
+
+    // Строит значение из args, только если ключа ещё нет
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> TryEmplace(Key &&key, Args &&...args) {
+        const size_t index = index_.LowerBound(keys_, key, comp_);
+        if (index != Size() && !comp_(key, keys_[index])) {
+            return {begin() + index, false};
+        }
+        EmplaceAt(index, std::forward<Key>(key), std::forward<Args>(args)...);
+        return {begin() + index, true};
+    }
+
+    // Вставляет пару или присваивает значение существующей
+    template <typename Key, typename Value>
+    std::pair<iterator, bool> InsertOrAssign(Key &&key, Value &&value) {
+        auto [it, inserted] = TryEmplace(std::forward<Key>(key), std::forward<Value>(value));
+        if (!inserted) {
+            values_[it - begin()] = std::forward<Value>(value);
+        }
+        return {it, inserted};
+    }
+
+    // Значение по ключу; если ключа нет, вставляет значение по умолчанию
+    V &operator[](const K &key) {
+        return values_[TryEmplace(key).first - begin()];
+    }
+
+    V &operator[](K &&key) {
+        return values_[TryEmplace(std::move(key)).first - begin()];
+    }
+
+    // Дописывает пары [first, last) в конец, сортирует только их и сливает с уже имеющимися за один
+    // проход. Для уже имеющихся ключей пары из диапазона отбрасываются, из новых эквивалентных
+    // берётся первая. Элементы диапазона — пары вида std::pair<K, V>. Если сравнение или
+    // копирование бросит, словарь не меняется
+    template <std::input_iterator InputIt>
+    void InsertRange(InputIt first, InputIt last) {
+        const size_t old_size = AppendPairs(first, last);
+        try {
+            SortAndMerge(old_size, false);
+        } catch (...) {
+            TruncateTo(old_size);
+            throw;
+        }
+    }
+
+    // То же для диапазона, уже упорядоченного по ключу и без повторов: сортировка пропускается
+    template <std::input_iterator InputIt>
+    void InsertRange(sorted_unique_t, InputIt first, InputIt last) {
+        const size_t old_size = AppendPairs(first, last);
+        assert(IsSortedUnique(old_size));
+        try {
+            SortAndMerge(old_size, true);
+        } catch (...) {
+            TruncateTo(old_size);
+            throw;
+        }
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - cbegin();
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        index_.Rebuild(keys_);
+        return begin() + index;
+    }
+
+    // Удаляет пару с ключом key и возвращает количество удалённых: 0 или 1
+    size_t Erase(const K &key) {
+        const size_t index = FindIndex(key);
+        if (index == Size()) {
+            return 0;
+        }
+        Erase(cbegin() + index);
+        return 1;
+    }
+
+    friend bool operator==(const FlatMap &lhs, const FlatMap &rhs) {
+        return std::equal(lhs.keys_.begin(), lhs.keys_.end(), rhs.keys_.begin(), rhs.keys_.end())
+               && std::equal(lhs.values_.begin(), lhs.values_.end(), rhs.values_.begin());
+    }
+
+private:
+    [[no_unique_address]] Compare comp_;
+    Vector<K, KeyAllocator> keys_;
+    Vector<V, ValueAllocator> values_;
+    [[no_unique_address]] Index index_;
+
+    // Пара в позиции index. operator[] занят поиском по ключу
+    reference Item(size_t index) noexcept {
+        return {keys_[index], values_[index]};
+    }
+
+    const_reference Item(size_t index) const noexcept {
+        return {keys_[index], values_[index]};
+    }
+
+    template <typename Key>
+    size_t FindIndex(const Key &key) const {
+        const size_t index = index_.LowerBound(keys_, key, comp_);
+        return index != Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    bool IsSortedUnique(size_t from) const {
+        return std::adjacent_find(keys_.begin() + from, keys_.end(),
+                                  [this](const K &lhs, const K &rhs) { return !comp_(lhs, rhs); })
+               == keys_.end();
+    }
+
+    // Вставляет пару в позицию index. Если вставка значения бросит, ключ убирается обратно
+    template <typename Key, typename... Args>
+    void EmplaceAt(size_t index, Key &&key, Args &&...args) {
+        keys_.Emplace(keys_.begin() + index, std::forward<Key>(key));
+        try {
+            values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        } catch (...) {
+            keys_.Erase(keys_.begin() + index);
+            throw;
+        }
+        index_.Rebuild(keys_);
+    }
+
+    // Дописывает пары в конец обоих массивов и возвращает прежний размер. Если что-то бросит,
+    // дописанное убирается
+    template <typename InputIt>
+    size_t AppendPairs(InputIt first, InputIt last) {
+        const size_t old_size = Size();
+        if constexpr (std::forward_iterator<InputIt>) {
+            Reserve(old_size + std::distance(first, last));
+        }
+        try {
+            for (; first != last; ++first) {
+                auto &&item = *first;
+                keys_.EmplaceBack(std::get<0>(std::forward<decltype(item)>(item)));
+                values_.EmplaceBack(std::get<1>(std::forward<decltype(item)>(item)));
+            }
+        } catch (...) {
+            TruncateTo(old_size);
+            throw;
+        }
+        return old_size;
+    }
+
+    // Отрезает пары, дописанные за size, в том числе ключ без значения
+    void TruncateTo(size_t size) {
+        keys_.Erase(keys_.begin() + size, keys_.end());
+        values_.Erase(values_.begin() + std::min(size, values_.Size()), values_.end());
+    }
+
+    // Упорядочивает пары по ключу, считая первые old_size уже упорядоченными, а при tail_sorted —
+    // и хвост тоже, и выбрасывает повторы, оставляя из эквивалентных первую по порядку. Сортируется
+    // перестановка индексов, по которой затем один раз переносятся оба массива. Если что-то бросит,
+    // keys_ и values_ остаются как были
+    void SortAndMerge(size_t old_size, bool tail_sorted) {
+        const size_t size = Size();
+        if (old_size == size) {
+            index_.Rebuild(keys_);
+            return;
+        }
+
+        auto key_less = [this](size_t lhs, size_t rhs) { return comp_(keys_[lhs], keys_[rhs]); };
+        Vector<size_t> order(size);
+        std::iota(order.begin(), order.end(), size_t{0});
+        if (!tail_sorted) {
+            std::stable_sort(order.begin() + old_size, order.end(), key_less);
+        }
+        std::inplace_merge(order.begin(), order.begin() + old_size, order.end(), key_less);
+        const auto order_end = std::unique(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return !key_less(lhs, rhs) && !key_less(rhs, lhs);
+        });
+        const size_t new_size = order_end - order.begin();
+
+        // Если перестановка тождественна и повторов нет, массивы уже в нужном порядке
+        if (new_size != size || !std::is_sorted(order.begin(), order_end)) {
+            Vector<K, KeyAllocator> keys(keys_.GetAllocator());
+            Vector<V, ValueAllocator> values(values_.GetAllocator());
+            Permute(order.Data(), new_size, keys, values);
+            keys_.Swap(keys);
+            values_.Swap(values);
+        }
+        index_.Rebuild(keys_);
+    }
+
+    // Собирает в keys и values элементы с индексами order[0..count) из keys_ и values_. Если
+    // копирование одного массива бросит, уже перемещённые элементы другого возвращаются на место
+    void Permute(const size_t *order, size_t count, Vector<K, KeyAllocator> &keys, Vector<V, ValueAllocator> &values) {
+        keys.Reserve(count);
+        values.Reserve(count);
+        try {
+            for (size_t i = 0; i < count; ++i) {
+                keys.UncheckedEmplaceBack(std::move_if_noexcept(keys_[order[i]]));
+                values.UncheckedEmplaceBack(std::move_if_noexcept(values_[order[i]]));
+            }
+        } catch (...) {
+            MoveBack(order, keys, keys_);
+            MoveBack(order, values, values_);
+            throw;
+        }
+    }
+
+    // Возвращает элементы from[i] на места to[order[i]], если они были перемещены без исключений
+    template <typename T, typename Allocator>
+    static void MoveBack(const size_t *order, Vector<T, Allocator> &from, Vector<T, Allocator> &to) noexcept {
+        if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            for (size_t i = 0; i < from.Size(); ++i) {
+                T *slot = &to[order[i]];
+                std::destroy_at(slot);
+                std::construct_at(slot, std::move(from[i]));
+            }
+        }
+    }
+};
+
+// Итератор хранит индекс пары и при разыменовании собирает прокси-ссылку из двух массивов
+template <typename K, typename V, typename Compare, typename KeyAllocator, typename ValueAllocator, typename Search>
+template <bool Const>
+class FlatMap<K, V, Compare, KeyAllocator, ValueAllocator, Search>::Iterator {
+    using Owner = std::conditional_t<Const, const FlatMap, FlatMap>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::pair<K, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const_reference, FlatMap::reference>;
+
+    Iterator() = default;
+
+    Iterator(Owner *owner, size_t index) noexcept : owner_(owner), index_(index) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    operator Iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return {owner_, index_};
+    }
+
+    reference operator*() const noexcept {
+        return owner_->Item(index_);
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return owner_->Item(index_ + n);
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        return {owner_, index_++};
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        return {owner_, index_--};
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Owner *owner_ = nullptr;
+    size_t index_ = 0;
+};
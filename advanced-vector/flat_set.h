@@ -0,0 +1,373 @@
+#pragma once
+#include "vector.h"
+
+#include <numeric>
+
+// Метка для конструкторов и InsertRange: входной диапазон уже упорядочен по Compare и не содержит
+// эквивалентных ключей, поэтому сортировать его не нужно
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail {
+
+template <typename Compare>
+concept TransparentCompare = requires { typename Compare::is_transparent; };
+
+// Двоичный поиск без ветвлений: на каждом шаге база сдвигается условной пересылкой, так что
+// промахи предсказателя не зависят от данных
+template <typename K, typename Key, typename Compare>
+size_t BranchlessLowerBound(const K *first, size_t n, const Key &key, const Compare &comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const K *base = first;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = comp(base[half - 1], key) ? base + half : base;
+        n -= half;
+    }
+    return (base - first) + comp(*base, key);
+}
+
+}  // namespace detail
+
+// Политики поиска для FlatSet и FlatMap. Index<K, Compare> хранится в контейнере, получает
+// Rebuild(keys) после каждого изменения ключей и отвечает на LowerBound(keys, key, comp)
+
+// Двоичный поиск по самому отсортированному массиву: дополнительной памяти не нужно
+struct BinarySearch {
+    template <typename K, typename Compare>
+    class Index {
+    public:
+        void Rebuild(std::span<const K>) noexcept {
+        }
+
+        template <typename Key>
+        size_t LowerBound(std::span<const K> keys, const Key &key, const Compare &comp) const {
+            return detail::BranchlessLowerBound(keys.data(), keys.size(), key, comp);
+        }
+    };
+};
+
+// Поиск по копии ключей в порядке Эйтцингера (дерево поиска, уложенное по уровням, как куча):
+// первые уровни, через которые проходит каждый поиск, лежат рядом и остаются в кэше. Выигрывает
+// на больших таблицах, которые редко меняются: каждое изменение перестраивает копию за O(n).
+// Если на копию не хватило памяти, поиск идёт двоичным, пока следующее изменение её не построит
+struct EytzingerSearch {
+    template <typename K, typename Compare>
+    class Index {
+    public:
+        void Rebuild(std::span<const K> keys) noexcept {
+            try {
+                Vector<size_t> ranks(keys.size());
+                size_t next = 0;
+                RankNodes(ranks, 1, next);
+                Vector<K> tree;
+                tree.Reserve(keys.size());
+                for (const size_t rank : ranks) {
+                    tree.UncheckedEmplaceBack(keys[rank]);
+                }
+                tree_.Swap(tree);
+                ranks_.Swap(ranks);
+            } catch (...) {
+                tree_.Clear(true);
+                ranks_.Clear(true);
+            }
+        }
+
+        template <typename Key>
+        size_t LowerBound(std::span<const K> keys, const Key &key, const Compare &comp) const {
+            const size_t n = keys.size();
+            if (tree_.Size() != n) {
+                return detail::BranchlessLowerBound(keys.data(), n, key, comp);
+            }
+            // Узел k (с единицы) хранится в tree_[k - 1], его потомки — узлы 2k и 2k + 1. Спуск идёт
+            // до листа, а последний поворот налево указывает на искомый узел
+            size_t k = 1;
+            while (k <= n) {
+                k = 2 * k + comp(tree_[k - 1], key);
+            }
+            k >>= std::countr_one(k) + 1;
+            return k == 0 ? n : ranks_[k - 1];
+        }
+
+    private:
+        Vector<K> tree_;
+        // Позиция узла в отсортированном массиве
+        Vector<size_t> ranks_;
+
+        // Нумерует узлы поддерева k в симметричном порядке. Глубина рекурсии — log2(n)
+        static void RankNodes(Vector<size_t> &ranks, size_t k, size_t &next) noexcept {
+            if (k > ranks.Size()) {
+                return;
+            }
+            RankNodes(ranks, 2 * k, next);
+            ranks[k - 1] = next++;
+            RankNodes(ranks, 2 * k + 1, next);
+        }
+    };
+};
+
+// Упорядоченное множество на отсортированном Vector: поиск двоичный (или по Search), обход идёт по
+// непрерывному массиву, а на каждый ключ не тратится отдельный узел, как в std::set. Вставка и
+// удаление одного ключа сдвигают хвост за O(n), поэтому наполнять множество лучше через
+// InsertRange или конструктор, которые сортируют и сливают всё за один раз.
+// Ключи изменять нельзя: итераторы константные
+template <typename K, typename Compare = std::less<K>, typename Allocator = std::allocator<K>,
+          typename Search = BinarySearch>
+class FlatSet {
+    using Index = typename Search::template Index<K, Compare>;
+
+public:
+    using key_type = K;
+    using value_type = K;
+    using key_compare = Compare;
+    using iterator = const K *;
+    using const_iterator = const K *;
+
+    iterator begin() const noexcept {
+        return keys_.begin();
+    }
+
+    iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare &comp) : comp_(comp) {
+    }
+
+    // Сортирует keys и оставляет из каждой группы эквивалентных ключей первый
+    explicit FlatSet(Vector<K, Allocator> keys, const Compare &comp = Compare()) : comp_(comp), keys_(std::move(keys)) {
+        std::stable_sort(keys_.begin(), keys_.end(), comp_);
+        RemoveDuplicates(0);
+        index_.Rebuild(keys_);
+    }
+
+    FlatSet(sorted_unique_t, Vector<K, Allocator> keys, const Compare &comp = Compare())
+        : comp_(comp), keys_(std::move(keys)) {
+        assert(IsSortedUnique(keys_.begin(), keys_.end()));
+        index_.Rebuild(keys_);
+    }
+
+    FlatSet(std::initializer_list<K> keys, const Compare &comp = Compare()) : comp_(comp) {
+        InsertRange(keys.begin(), keys.end());
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    const K &operator[](size_t index) const noexcept {
+        return keys_[index];
+    }
+
+    // Ключи по возрастанию одним массивом
+    const Vector<K, Allocator> &Keys() const noexcept {
+        return keys_;
+    }
+
+    // Забирает массив ключей, оставляя множество пустым
+    Vector<K, Allocator> Extract() && noexcept {
+        Vector<K, Allocator> keys(std::move(keys_));
+        index_.Rebuild(keys_);
+        return keys;
+    }
+
+    key_compare KeyComp() const {
+        return comp_;
+    }
+
+    void Swap(FlatSet &other) noexcept {
+        using std::swap;
+        swap(comp_, other.comp_);
+        keys_.Swap(other.keys_);
+        swap(index_, other.index_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        index_.Rebuild(keys_);
+    }
+
+    // Первый ключ, не меньший key
+    iterator LowerBound(const K &key) const {
+        return begin() + index_.LowerBound(keys_, key, comp_);
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    iterator LowerBound(const Key &key) const {
+        return begin() + index_.LowerBound(keys_, key, comp_);
+    }
+
+    // Первый ключ, больший key
+    iterator UpperBound(const K &key) const {
+        const iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it + 1 : it;
+    }
+
+    iterator Find(const K &key) const {
+        return FindImpl(key);
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    iterator Find(const Key &key) const {
+        return FindImpl(key);
+    }
+
+    bool Contains(const K &key) const {
+        return Find(key) != end();
+    }
+
+    template <typename Key>
+        requires detail::TransparentCompare<Compare>
+    bool Contains(const Key &key) const {
+        return Find(key) != end();
+    }
+
+    // Вставляет key, если эквивалентного ещё нет. Возвращает позицию ключа и признак вставки
+    std::pair<iterator, bool> Insert(const K &key) {
+        return InsertUnique(key);
+    }
+
+    std::pair<iterator, bool> Insert(K &&key) {
+        return InsertUnique(std::move(key));
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> Emplace(Args &&...args) {
+        return InsertUnique(K(std::forward<Args>(args)...));
+    }
+
+    // Дописывает ключи [first, last) в конец, сортирует только их и сливает с уже имеющимися за
+    // один проход. Уже имеющиеся ключи остаются, из новых эквивалентных берётся первый. Если
+    // сравнение или копирование бросит, множество не меняется
+    template <std::input_iterator InputIt>
+    void InsertRange(InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        keys_.Insert(keys_.end(), first, last);
+        try {
+            std::stable_sort(keys_.begin() + old_size, keys_.end(), comp_);
+            MergeTail(old_size);
+        } catch (...) {
+            keys_.Erase(keys_.begin() + old_size, keys_.end());
+            throw;
+        }
+    }
+
+    // То же для диапазона, уже упорядоченного и без повторов: сортировка пропускается
+    template <std::input_iterator InputIt>
+    void InsertRange(sorted_unique_t, InputIt first, InputIt last) {
+        const size_t old_size = keys_.Size();
+        keys_.Insert(keys_.end(), first, last);
+        assert(IsSortedUnique(keys_.begin() + old_size, keys_.end()));
+        try {
+            MergeTail(old_size);
+        } catch (...) {
+            keys_.Erase(keys_.begin() + old_size, keys_.end());
+            throw;
+        }
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - begin();
+        keys_.Erase(pos);
+        index_.Rebuild(keys_);
+        return begin() + index;
+    }
+
+    // Удаляет ключ, эквивалентный key, и возвращает количество удалённых: 0 или 1
+    size_t Erase(const K &key) {
+        const iterator it = Find(key);
+        if (it == end()) {
+            return 0;
+        }
+        Erase(it);
+        return 1;
+    }
+
+    friend bool operator==(const FlatSet &lhs, const FlatSet &rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    [[no_unique_address]] Compare comp_;
+    Vector<K, Allocator> keys_;
+    [[no_unique_address]] Index index_;
+
+    bool Equivalent(const K &lhs, const K &rhs) const {
+        return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+    }
+
+    template <typename It>
+    bool IsSortedUnique(It first, It last) const {
+        return std::adjacent_find(first, last, [this](const K &lhs, const K &rhs) { return !comp_(lhs, rhs); })
+               == last;
+    }
+
+    template <typename Key>
+    iterator FindImpl(const Key &key) const {
+        const iterator it = begin() + index_.LowerBound(keys_, key, comp_);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    template <typename Value>
+    std::pair<iterator, bool> InsertUnique(Value &&key) {
+        const iterator it = LowerBound(key);
+        if (it != end() && !comp_(key, *it)) {
+            return {it, false};
+        }
+        const size_t index = it - begin();
+        keys_.Insert(it, std::forward<Value>(key));
+        index_.Rebuild(keys_);
+        return {begin() + index, true};
+    }
+
+    // Удаляет повторы в уже отсортированном массиве, начиная с позиции from
+    void RemoveDuplicates(size_t from) {
+        const auto first = keys_.begin() + from;
+        const auto new_end = std::unique(first, keys_.end(), [this](const K &lhs, const K &rhs) {
+            return Equivalent(lhs, rhs);
+        });
+        keys_.Erase(new_end, keys_.end());
+    }
+
+    // Сливает отсортированный хвост с позиции old_size с отсортированным началом. Слияние
+    // устойчивое, поэтому из эквивалентных ключей первым стоит уже имевшийся. Ключи до old_size
+    // меняются, только когда сравнения позади: сливается перестановка индексов, а затем ключи один
+    // раз переносятся по ней в новый буфер, перемещением, если оно не бросает, иначе копированием.
+    // Так исключение оставляет начало нетронутым, а хвост вызывающий просто отрезает
+    void MergeTail(size_t old_size) {
+        const auto mid = keys_.begin() + old_size;
+        if (old_size != 0 && mid != keys_.end() && !comp_(*(mid - 1), *mid)) {
+            auto key_less = [this](size_t lhs, size_t rhs) { return comp_(keys_[lhs], keys_[rhs]); };
+            Vector<size_t> order(keys_.Size());
+            std::iota(order.begin(), order.end(), size_t{0});
+            std::inplace_merge(order.begin(), order.begin() + old_size, order.end(), key_less);
+            const auto order_end = std::unique(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+                return Equivalent(keys_[lhs], keys_[rhs]);
+            });
+
+            Vector<K, Allocator> keys(keys_.GetAllocator());
+            keys.Reserve(order_end - order.begin());
+            for (auto it = order.begin(); it != order_end; ++it) {
+                keys.UncheckedEmplaceBack(std::move_if_noexcept(keys_[*it]));
+            }
+            keys_.Swap(keys);
+        } else {
+            // Новые ключи целиком больше старых: повторы возможны только среди них
+            RemoveDuplicates(old_size);
+        }
+        index_.Rebuild(keys_);
+    }
+};
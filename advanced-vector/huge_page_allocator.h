@@ -0,0 +1,206 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Способ размещения больших блоков по узлам NUMA
+enum class NumaPolicy {
+    kLocal,       // по умолчанию ядра: страница достаётся узлу, который первым её тронул
+    kBind,        // только узлы из node_mask
+    kInterleave,  // страницы по очереди раскладываются по узлам из node_mask
+};
+
+struct HugePageOptions {
+    // Блоки меньше порога берутся из обычной кучи, остальные отображаются через mmap
+    size_t threshold_bytes = size_t{32} << 20;
+    // MAP_HUGETLB требует заранее зарезервированных страниц (vm.nr_hugepages). Если их нет,
+    // блок отображается обычными страницами с MADV_HUGEPAGE
+    bool use_hugetlb = false;
+    // Если ядро не применит политику, allocate бросит std::system_error
+    NumaPolicy numa = NumaPolicy::kLocal;
+    unsigned long node_mask = 0;
+
+    friend bool operator==(const HugePageOptions &, const HugePageOptions &) = default;
+};
+
+namespace detail {
+
+inline constexpr size_t kHugePageSize = size_t{2} << 20;
+
+constexpr size_t RoundUpToHugePage(size_t bytes) noexcept {
+    return (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+
+// Подсказка THP лишь оптимизация: ядро без THP вернёт ошибку, и блок останется на обычных страницах
+inline void AdviseHugePages(void *p, size_t bytes) noexcept {
+    ::madvise(p, bytes, MADV_HUGEPAGE);
+}
+
+// Применяет к отображённому диапазону политику NUMA. Возвращает 0 или errno от mbind. Политика
+// принадлежит отображению, и mremap переносит её вместе с ним, так что при росте её не повторяют
+inline int BindToNodes(void *p, size_t bytes, const HugePageOptions &options) noexcept {
+    if (options.numa == NumaPolicy::kLocal || options.node_mask == 0) {
+        return 0;
+    }
+    const int mode = options.numa == NumaPolicy::kBind ? MPOL_BIND : MPOL_INTERLEAVE;
+    // Ядро читает maxnode - 1 бит маски, поэтому для всех её битов нужен ещё один
+    const unsigned long max_node = sizeof(options.node_mask) * 8 + 1;
+    if (::syscall(SYS_mbind, p, bytes, mode, &options.node_mask, max_node, 0) != 0) {
+        return errno;
+    }
+    return 0;
+}
+
+// Отображает bytes байт (кратно kHugePageSize) анонимной памяти, выровненной по kHugePageSize,
+// чтобы THP мог покрыть блок целиком. Возвращает nullptr при неудаче
+inline void *MapHugePages(size_t bytes, const HugePageOptions &options) noexcept {
+    if (options.use_hugetlb) {
+        void *p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+    }
+
+    // mmap выравнивает только по обычной странице: берём с запасом и обрезаем края
+    const size_t padded = bytes + kHugePageSize;
+    void *raw = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    auto *begin = static_cast<std::byte *>(raw);
+    auto *aligned = reinterpret_cast<std::byte *>(
+        (reinterpret_cast<std::uintptr_t>(begin) + kHugePageSize - 1) & ~(kHugePageSize - 1));
+    if (aligned != begin) {
+        ::munmap(begin, aligned - begin);
+    }
+    if (const size_t tail = begin + padded - (aligned + bytes); tail != 0) {
+        ::munmap(aligned + bytes, tail);
+    }
+    AdviseHugePages(aligned, bytes);
+    return aligned;
+}
+
+}  // namespace detail
+
+// Аллокатор для очень больших векторов. Блоки от threshold_bytes отображаются через mmap на
+// огромные страницы с заданной политикой NUMA, а рост тривиально перемещаемых элементов идёт через
+// mremap: ядро переносит таблицы страниц, не копируя данные. Мелкие блоки берутся из кучи
+//
+//   Vector<Record, HugePageAllocator<Record>> table(HugePageAllocator<Record>({.numa = NumaPolicy::kInterleave,
+//                                                                              .node_mask = 0b11}));
+template <typename T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+
+    static_assert(alignof(T) <= detail::kHugePageSize);
+
+    HugePageAllocator() = default;
+
+    explicit HugePageAllocator(const HugePageOptions &options) noexcept : options_(options) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U> &other) noexcept : options_(other.Options()) {
+    }
+
+    const HugePageOptions &Options() const noexcept {
+        return options_;
+    }
+
+    T *allocate(size_t n) {
+        const size_t bytes = Bytes(n);
+        if (!IsLarge(bytes)) {
+            return static_cast<T *>(::operator new(bytes, std::align_val_t(alignof(T))));
+        }
+        const size_t mapped = detail::RoundUpToHugePage(bytes);
+        void *p = detail::MapHugePages(mapped, options_);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (const int error = detail::BindToNodes(p, mapped, options_); error != 0) {
+            ::munmap(p, mapped);
+            throw std::system_error(error, std::generic_category(), "mbind");
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!IsLarge(bytes)) {
+            ::operator delete(p, bytes, std::align_val_t(alignof(T)));
+        } else {
+            ::munmap(p, detail::RoundUpToHugePage(bytes));
+        }
+    }
+
+    // Расширяет отображение на месте, если за ним свободно адресное пространство
+    bool try_expand(T *p, size_t old_n, size_t new_n) noexcept {
+        const size_t old_bytes = old_n * sizeof(T);
+        if (!IsLarge(old_bytes) || new_n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            return false;
+        }
+        const size_t old_mapped = detail::RoundUpToHugePage(old_bytes);
+        const size_t new_mapped = detail::RoundUpToHugePage(new_n * sizeof(T));
+        if (new_mapped == old_mapped) {
+            return true;
+        }
+        return ::mremap(p, old_mapped, new_mapped, 0) != MAP_FAILED;
+    }
+
+    // Отдаёт ядру хвост большого отображения, не сдвигая начало
+    bool try_shrink(T *p, size_t old_n, size_t new_n) noexcept {
+        const size_t new_bytes = new_n * sizeof(T);
+        if (!IsLarge(new_bytes)) {
+            return false;
+        }
+        const size_t old_mapped = detail::RoundUpToHugePage(old_n * sizeof(T));
+        const size_t new_mapped = detail::RoundUpToHugePage(new_bytes);
+        return new_mapped == old_mapped || ::mremap(p, old_mapped, new_mapped, 0) != MAP_FAILED;
+    }
+
+    // Большой блок переносится через mremap, переходы через порог копируются. При неудаче
+    // исходный блок остаётся нетронутым
+    T *reallocate(T *p, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = Bytes(new_n);
+        if (IsLarge(old_bytes) && IsLarge(new_bytes)) {
+            const size_t new_mapped = detail::RoundUpToHugePage(new_bytes);
+            void *moved = ::mremap(p, detail::RoundUpToHugePage(old_bytes), new_mapped, MREMAP_MAYMOVE);
+            if (moved != MAP_FAILED) {
+                return static_cast<T *>(moved);
+            }
+        }
+
+        T *fresh = allocate(new_n);
+        std::memcpy(static_cast<void *>(fresh), static_cast<const void *>(p), std::min(old_bytes, new_bytes));
+        deallocate(p, old_n);
+        return fresh;
+    }
+
+    // Блок может освободить только аллокатор с тем же порогом и тем же способом отображения
+    friend bool operator==(const HugePageAllocator &lhs, const HugePageAllocator &rhs) noexcept {
+        return lhs.options_ == rhs.options_;
+    }
+
+private:
+    HugePageOptions options_;
+
+    bool IsLarge(size_t bytes) const noexcept {
+        return bytes >= options_.threshold_bytes;
+    }
+
+    static size_t Bytes(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - detail::kHugePageSize) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+};
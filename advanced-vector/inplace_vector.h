@@ -0,0 +1,332 @@
+#pragma once
+#include "vector.h"
+
+// Вектор фиксированной вместимости N, целиком лежащий в объекте: ни кучи, ни ветки на случай
+// переполнения встроенного буфера, как у SmallVector. Семантика Emplace/Erase/Resize и гарантии
+// исключений те же, что у Vector при достаточной вместимости, а при нехватке места EmplaceBack,
+// Insert и Resize бросают std::bad_alloc. TryEmplaceBack вместо этого возвращает nullptr.
+//
+// Все операции constexpr, поэтому таблицы можно строить при компиляции:
+//
+//   constexpr auto kSquares = [] {
+//       InplaceVector<int, 16> squares;
+//       for (int i = 0; i < 5; ++i) {
+//           squares.PushBack(i * i);
+//       }
+//       return squares;
+//   }();
+//   static_assert(kSquares.Size() == 5 && kSquares[4] == 16);
+//
+// Таблица может быть заполнена не целиком, если T тривиально создаётся по умолчанию: при
+// компиляции незанятые ячейки обнуляются.
+//
+// Для тривиально копируемых T вектор сам тривиально копируем: копируется memcpy и может лежать в
+// разделяемой памяти или передаваться в регистрах
+template <typename T, size_t N>
+class InplaceVector {
+    static_assert(N > 0);
+
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    constexpr iterator begin() noexcept {
+        return Data();
+    }
+
+    constexpr iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    constexpr const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    constexpr const_iterator end() const noexcept {
+        return cend();
+    }
+
+    constexpr const_iterator cbegin() const noexcept {
+        return Data();
+    }
+
+    constexpr const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    constexpr T *Data() noexcept {
+        return storage_.elements;
+    }
+
+    constexpr const T *Data() const noexcept {
+        return storage_.elements;
+    }
+
+    constexpr InplaceVector() noexcept = default;
+
+    constexpr explicit InplaceVector(size_t size) {
+        Resize(size);
+    }
+
+    constexpr InplaceVector(const InplaceVector &)
+        requires std::is_trivially_copy_constructible_v<T>
+    = default;
+
+    constexpr InplaceVector(const InplaceVector &other) {
+        ConstructFrom(other.begin(), other.size_);
+    }
+
+    // Как и std::inplace_vector, перемещение переносит элементы по одному, а в other остаются
+    // перемещённые из них объекты
+    constexpr InplaceVector(InplaceVector &&)
+        requires std::is_trivially_move_constructible_v<T>
+    = default;
+
+    constexpr InplaceVector(InplaceVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        ConstructFrom(std::make_move_iterator(other.begin()), other.size_);
+    }
+
+    constexpr InplaceVector &operator=(const InplaceVector &)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+
+    constexpr InplaceVector &operator=(const InplaceVector &rhs) {
+        if (this != &rhs) {
+            AssignFrom(rhs.begin(), rhs.size_);
+        }
+        return *this;
+    }
+
+    constexpr InplaceVector &operator=(InplaceVector &&)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+
+    constexpr InplaceVector &operator=(InplaceVector &&rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                     && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            AssignFrom(std::make_move_iterator(rhs.begin()), rhs.size_);
+        }
+        return *this;
+    }
+
+    constexpr ~InplaceVector()
+        requires std::is_trivially_destructible_v<T>
+    = default;
+
+    constexpr ~InplaceVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    constexpr const T &operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr T &operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr void Swap(InplaceVector &other) noexcept(std::is_nothrow_swappable_v<T>
+                                                       && std::is_nothrow_move_constructible_v<T>) {
+        InplaceVector &shorter = size_ < other.size_ ? *this : other;
+        InplaceVector &longer = size_ < other.size_ ? other : *this;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        for (size_t i = shorter.size_; i < longer.size_; ++i) {
+            std::construct_at(shorter.Data() + i, std::move(longer.Data()[i]));
+        }
+        std::destroy(longer.begin() + shorter.size_, longer.end());
+        std::swap(size_, other.size_);
+    }
+
+    // Бросает std::bad_alloc, если new_size > N
+    constexpr void Resize(size_t new_size) {
+        if (new_size > N) {
+            throw std::bad_alloc();
+        }
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+            size_ = new_size;
+        }
+        while (size_ < new_size) {
+            std::construct_at(Data() + size_);
+            ++size_;
+        }
+    }
+
+    constexpr void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    constexpr void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    constexpr void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Бросает std::bad_alloc, если вектор полон
+    template <typename... Args>
+    constexpr T &EmplaceBack(Args &&...args) {
+        if (size_ == N) {
+            throw std::bad_alloc();
+        }
+        return UncheckedEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Строит элемент, если есть место, и возвращает указатель на него, иначе nullptr. Исключения
+    // может бросить только конструктор T
+    template <typename... Args>
+    constexpr T *TryEmplaceBack(Args &&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        if (size_ == N) {
+            return nullptr;
+        }
+        return &UncheckedEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    constexpr T *TryPushBack(const T &value) noexcept(std::is_nothrow_copy_constructible_v<T>) {
+        return TryEmplaceBack(value);
+    }
+
+    constexpr T *TryPushBack(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        return TryEmplaceBack(std::move(value));
+    }
+
+    // Место должно быть: проверяется только assert
+    template <typename... Args>
+    constexpr T &UncheckedEmplaceBack(Args &&...args) {
+        assert(size_ < N);
+        T *slot = std::construct_at(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(Data() + size_);
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T &value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T &&value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Бросает std::bad_alloc, если вектор полон
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args &&...args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        if (size_ == N) {
+            throw std::bad_alloc();
+        }
+        detail::EmplaceInPlace(Data(), size_, index, std::forward<Args>(args)...);
+        ++size_;
+        return begin() + index;
+    }
+
+    constexpr iterator Erase(const_iterator pos) noexcept(is_trivially_relocatable_v<T>
+                                                          || std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr iterator Erase(const_iterator first, const_iterator last) noexcept(is_trivially_relocatable_v<T>
+                                                                                 || std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+
+        if (count != 0) {
+            // memmove, которым Vector сдвигает тривиально перемещаемые элементы, при компиляции
+            // недоступен
+            if (std::is_constant_evaluated()) {
+                std::move(begin() + index + count, end(), begin() + index);
+                std::destroy(end() - count, end());
+            } else {
+                detail::EraseRange(Data(), size_, index, count);
+            }
+            size_ -= count;
+        }
+        return begin() + index;
+    }
+
+    friend constexpr bool operator==(const InplaceVector &lhs, const InplaceVector &rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    // Объединение не создаёт элементов: они строятся по одному через construct_at. Для
+    // тривиально копируемых T все специальные функции тривиальны, и тривиальность переходит к
+    // InplaceVector.
+    //
+    // Результат константного вычисления не может содержать неинициализированных ячеек, поэтому
+    // при компиляции массив тривиально создаваемых T заполняется нулями, иначе таблица размером
+    // меньше N не была бы константой. Во время выполнения память по-прежнему не трогается
+    union Storage {
+        constexpr Storage() noexcept {
+            if constexpr (std::is_trivially_default_constructible_v<T>) {
+                if (std::is_constant_evaluated()) {
+                    for (T &element : elements) {
+                        element = T();
+                    }
+                }
+            }
+        }
+
+        constexpr ~Storage()
+            requires std::is_trivially_destructible_v<T>
+        = default;
+
+        constexpr ~Storage() {
+        }
+
+        T elements[N];
+    };
+
+    Storage storage_;
+    size_t size_ = 0;
+
+    // Строит первые count элементов из first в пустом векторе. Если конструктор бросит, уже
+    // построенные элементы уничтожаются
+    template <typename InputIt>
+    constexpr void ConstructFrom(InputIt first, size_t count) {
+        try {
+            for (; size_ < count; ++size_, ++first) {
+                std::construct_at(Data() + size_, *first);
+            }
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    template <typename InputIt>
+    constexpr void AssignFrom(InputIt first, size_t count) {
+        const size_t common = std::min(size_, count);
+        for (size_t i = 0; i < common; ++i, ++first) {
+            Data()[i] = *first;
+        }
+        if (count < size_) {
+            std::destroy_n(Data() + count, size_ - count);
+            size_ = count;
+        }
+        for (; size_ < count; ++size_, ++first) {
+            std::construct_at(Data() + size_, *first);
+        }
+    }
+};
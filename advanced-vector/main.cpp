@@ -1 +1,298 @@
-/* разместите свой код в этом файле */
\ No newline at end of file
+// Бенчмарки Vector в сравнении с std::vector на Google Benchmark.
+//
+// Сборка и запуск с выгрузкой результатов в JSON (цель bench_json в корневом CMakeLists.txt):
+//   cmake -S . -B build && cmake --build build --target bench_json
+
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Тривиально копируемый тип: все переносы сводятся к memcpy
+using Trivial = std::int64_t;
+
+// Перемещается без исключений, но не тривиально перемещаем
+using NothrowMovable = std::string;
+
+// Только копируется, и копирование может бросить: Vector обязан копировать при переразмещении
+struct ThrowingCopyOnly {
+    ThrowingCopyOnly() = default;
+
+    explicit ThrowingCopyOnly(std::int64_t v) : value(v) {
+    }
+
+    ThrowingCopyOnly(const ThrowingCopyOnly &other) : value(other.value), payload(other.payload) {
+    }
+
+    ThrowingCopyOnly &operator=(const ThrowingCopyOnly &) = default;
+
+    std::int64_t value = 0;
+    std::array<char, 24> payload{};
+};
+
+template <typename T>
+T MakeValue(std::int64_t i) {
+    if constexpr (std::is_same_v<T, NothrowMovable>) {
+        // Достаточно длинная строка, чтобы не помещаться в SSO
+        return std::string(32, static_cast<char>('a' + i % 26));
+    } else {
+        return T(i);
+    }
+}
+
+// Единый интерфейс к обоим контейнерам, чтобы один и тот же бенчмарк мерил оба
+
+template <typename T>
+void PushBack(Vector<T> &v, const T &value) {
+    v.PushBack(value);
+}
+
+template <typename T>
+void PushBack(std::vector<T> &v, const T &value) {
+    v.push_back(value);
+}
+
+template <typename T>
+void EmplaceBack(Vector<T> &v, std::int64_t i) {
+    v.EmplaceBack(MakeValue<T>(i));
+}
+
+template <typename T>
+void EmplaceBack(std::vector<T> &v, std::int64_t i) {
+    v.emplace_back(MakeValue<T>(i));
+}
+
+template <typename T>
+void InsertAt(Vector<T> &v, size_t index, const T &value) {
+    v.Insert(v.begin() + index, value);
+}
+
+template <typename T>
+void InsertAt(std::vector<T> &v, size_t index, const T &value) {
+    v.insert(v.begin() + index, value);
+}
+
+template <typename T>
+void EraseAt(Vector<T> &v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(std::vector<T> &v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T>
+void Reserve(Vector<T> &v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Reserve(std::vector<T> &v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+void Resize(Vector<T> &v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename T>
+void Resize(std::vector<T> &v, size_t size) {
+    v.resize(size);
+}
+
+template <typename T>
+size_t Size(const Vector<T> &v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t Size(const std::vector<T> &v) {
+    return v.size();
+}
+
+template <typename Container>
+using ValueOf = std::decay_t<decltype(*std::declval<Container &>().begin())>;
+
+template <typename Container>
+Container MakeFilled(size_t n) {
+    Container c;
+    for (size_t i = 0; i < n; ++i) {
+        PushBack(c, MakeValue<ValueOf<Container>>(static_cast<std::int64_t>(i)));
+    }
+    return c;
+}
+
+template <typename Container>
+void BM_PushBackGrowth(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto value = MakeValue<ValueOf<Container>>(42);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(c, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_EmplaceBackGrowth(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            EmplaceBack(c, static_cast<std::int64_t>(i));
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_InsertFront(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto value = MakeValue<ValueOf<Container>>(42);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            InsertAt(c, 0, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_InsertMiddle(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto value = MakeValue<ValueOf<Container>>(42);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            InsertAt(c, Size(c) / 2, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_EraseFront(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto prototype = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container c = prototype;
+        state.ResumeTiming();
+        while (Size(c) != 0) {
+            EraseAt(c, 0);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_EraseMiddle(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto prototype = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container c = prototype;
+        state.ResumeTiming();
+        while (Size(c) != 0) {
+            EraseAt(c, Size(c) / 2);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Стоимость переразмещения: Reserve переносит n элементов в буфер вдвое больше
+template <typename Container>
+void BM_Reserve(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto prototype = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container c = prototype;
+        state.ResumeTiming();
+        Reserve(c, 2 * n);
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Ветка operator=, в которой вместимости приёмника не хватает и строится новая копия
+template <typename Container>
+void BM_CopyAssignReallocating(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto source = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        Container c;
+        c = source;
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Ветка operator=, в которой элементы присваиваются поверх уже созданных
+template <typename Container>
+void BM_CopyAssignInPlace(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto source = MakeFilled<Container>(n);
+    auto c = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        c = source;
+        benchmark::DoNotOptimize(c.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_Resize(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Container c;
+        Resize(c, n);
+        benchmark::DoNotOptimize(c.begin());
+        Resize(c, n / 2);
+        Resize(c, n);
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+}  // namespace
+
+// Каждый бенчмарк регистрируется для трёх типов элементов и обоих контейнеров
+#define VECTOR_BENCHMARK(func, lo, hi)                                       \
+    BENCHMARK_TEMPLATE(func, Vector<Trivial>)->Range(lo, hi);                \
+    BENCHMARK_TEMPLATE(func, std::vector<Trivial>)->Range(lo, hi);           \
+    BENCHMARK_TEMPLATE(func, Vector<NothrowMovable>)->Range(lo, hi);         \
+    BENCHMARK_TEMPLATE(func, std::vector<NothrowMovable>)->Range(lo, hi);    \
+    BENCHMARK_TEMPLATE(func, Vector<ThrowingCopyOnly>)->Range(lo, hi);       \
+    BENCHMARK_TEMPLATE(func, std::vector<ThrowingCopyOnly>)->Range(lo, hi)
+
+VECTOR_BENCHMARK(BM_PushBackGrowth, 8, 1 << 16);
+VECTOR_BENCHMARK(BM_EmplaceBackGrowth, 8, 1 << 16);
+VECTOR_BENCHMARK(BM_InsertFront, 8, 1 << 12);
+VECTOR_BENCHMARK(BM_InsertMiddle, 8, 1 << 12);
+VECTOR_BENCHMARK(BM_EraseFront, 64, 1 << 12);
+VECTOR_BENCHMARK(BM_EraseMiddle, 64, 1 << 12);
+VECTOR_BENCHMARK(BM_Reserve, 64, 1 << 16);
+VECTOR_BENCHMARK(BM_CopyAssignReallocating, 8, 1 << 16);
+VECTOR_BENCHMARK(BM_CopyAssignInPlace, 8, 1 << 16);
+VECTOR_BENCHMARK(BM_Resize, 8, 1 << 16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,385 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class MapMode {
+    kReadWrite,  // файл создаётся, если его нет, и растёт вместе с вектором
+    kReadOnly,   // существующий файл отображается только для чтения
+};
+
+// Заголовок в начале файла MappedVector. Размер и вместимость хранятся прямо в нём, поэтому
+// содержимое файла всегда согласовано с тем, что видит вектор
+struct MappedVectorHeader {
+    static constexpr std::uint64_t kMagic = 0x3152544345564d41;  // "AMVECTR1"
+    static constexpr std::uint32_t kFormatVersion = 1;
+
+    std::uint64_t magic;
+    std::uint32_t format_version;
+    std::uint32_t schema_version;
+    std::uint32_t element_size;
+    std::uint32_t element_align;
+    std::uint64_t size;
+    std::uint64_t capacity;
+};
+
+// Вектор тривиально копируемых элементов, лежащий в отображённом в память файле. После перезапуска
+// таблица не перестраивается, а отображается заново. Интерфейс повторяет Vector; рост расширяет
+// файл ftruncate и переотображает его через mremap без копирования данных.
+// SchemaVersion записывается в заголовок: при смене формата записи T его нужно увеличить, и старый
+// файл перестанет открываться.
+//
+// Отображение kReadOnly защищено от записи, поэтому все неконстантные методы, включая operator[],
+// Data() и begin(), бросают для него std::logic_error, а не падают на записи в страницу. Читать
+// такой вектор нужно через const-ссылку
+template <typename T, std::uint32_t SchemaVersion = 0, typename GrowthPolicy = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable records can live in a file");
+
+public:
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    iterator begin() {
+        return Data();
+    }
+
+    iterator end() {
+        return Data() + Size();
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return Elements();
+    }
+
+    const_iterator cend() const noexcept {
+        return Elements() + Size();
+    }
+
+    // Открывает файл path. В режиме kReadWrite пустой или отсутствующий файл инициализируется
+    // пустым вектором. Бросает std::system_error при ошибках ОС и std::runtime_error, если
+    // заголовок не подходит к T или SchemaVersion
+    explicit MappedVector(const std::filesystem::path &path, MapMode mode = MapMode::kReadWrite)
+        : read_only_(mode == MapMode::kReadOnly) {
+        fd_ = read_only_ ? ::open(path.c_str(), O_RDONLY | O_CLOEXEC)
+                         : ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        try {
+            MapFile();
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector &) = delete;
+    MappedVector &operator=(const MappedVector &) = delete;
+
+    MappedVector(MappedVector &&other) noexcept
+        : fd_(std::exchange(other.fd_, -1)),
+          base_(std::exchange(other.base_, nullptr)),
+          mapped_bytes_(std::exchange(other.mapped_bytes_, 0)),
+          read_only_(other.read_only_) {
+    }
+
+    MappedVector &operator=(MappedVector &&rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            base_ = std::exchange(rhs.base_, nullptr);
+            mapped_bytes_ = std::exchange(rhs.mapped_bytes_, 0);
+            read_only_ = rhs.read_only_;
+        }
+        return *this;
+    }
+
+    // Изменения уже лежат в страничном кэше; на диск их отправит ядро или Flush
+    ~MappedVector() {
+        Close();
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return Elements()[index];
+    }
+
+    T &operator[](size_t index) {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    T *Data() {
+        CheckWritable();
+        return Elements();
+    }
+
+    const T *Data() const noexcept {
+        return Elements();
+    }
+
+    size_t Size() const noexcept {
+        return Header().size;
+    }
+
+    size_t Capacity() const noexcept {
+        return Header().capacity;
+    }
+
+    bool IsReadOnly() const noexcept {
+        return read_only_;
+    }
+
+    // Дескриптор файла и смещение первого элемента в нём: для sendfile и прочего прямого доступа
+    int NativeHandle() const noexcept {
+        return fd_;
+    }
+
+    static constexpr size_t DataOffset() noexcept {
+        return kDataOffset;
+    }
+
+    // Синхронно сбрасывает отображение на диск
+    void Flush() {
+        if (::msync(base_, mapped_bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    void Reserve(size_t new_capacity) {
+        CheckWritable();
+        if (new_capacity > Capacity()) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Отдаёт файловой системе хвост файла за последним элементом
+    void ShrinkToFit() {
+        CheckWritable();
+        if (Capacity() > Size()) {
+            Remap(Size());
+        }
+    }
+
+    void Resize(size_t new_size) {
+        CheckWritable();
+        const size_t size = Size();
+        if (new_size > size) {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Elements() + size, new_size - size);
+        }
+        SetSize(new_size);
+    }
+
+    void Clear() {
+        CheckWritable();
+        SetSize(0);
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        return *Emplace(end(), std::forward<Args>(args)...);
+    }
+
+    void PopBack() {
+        CheckWritable();
+        assert(Size() > 0);
+        SetSize(Size() - 1);
+    }
+
+    iterator Insert(const_iterator pos, const T &value) {
+        return Emplace(pos, value);
+    }
+
+    // Значение строится до роста: аргументы могут ссылаться на элементы, которые mremap сдвинет
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args &&...args) {
+        CheckWritable();
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        const size_t size = Size();
+
+        T value(std::forward<Args>(args)...);
+        if (size == Capacity()) {
+            Remap(GrowthPolicy::template NextCapacity<T>(size, size + 1));
+        }
+        detail::EmplaceInPlace(Elements(), size, index, std::move(value));
+        SetSize(size + 1);
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) {
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        CheckWritable();
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+
+        if (count != 0) {
+            detail::EraseRange(Elements(), Size(), index, count);
+            SetSize(Size() - count);
+        }
+        return begin() + index;
+    }
+
+private:
+    // Данные начинаются с границы строки кэша или alignof(T), если он больше. Само отображение
+    // выровнено по странице, так что это выравнивание сохраняется в памяти
+    static constexpr size_t kDataAlignment = std::max(alignof(T), kCacheLineSize);
+    static constexpr size_t kDataOffset = (sizeof(MappedVectorHeader) + kDataAlignment - 1) & ~(kDataAlignment - 1);
+
+    static_assert(alignof(T) <= 4096, "mapping is only page-aligned");
+
+    int fd_ = -1;
+    void *base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    bool read_only_ = false;
+
+    static size_t FileBytes(size_t capacity) {
+        if (capacity > (std::numeric_limits<size_t>::max() - kDataOffset) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return kDataOffset + capacity * sizeof(T);
+    }
+
+    [[noreturn]] static void ThrowSystemError(const char *what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    T *Elements() const noexcept {
+        return reinterpret_cast<T *>(static_cast<std::byte *>(base_) + kDataOffset);
+    }
+
+    void CheckWritable() const {
+        if (read_only_) {
+            throw std::logic_error("MappedVector: the mapping is read-only");
+        }
+    }
+
+    MappedVectorHeader &Header() noexcept {
+        return *static_cast<MappedVectorHeader *>(base_);
+    }
+
+    const MappedVectorHeader &Header() const noexcept {
+        return *static_cast<const MappedVectorHeader *>(base_);
+    }
+
+    void SetSize(size_t size) noexcept {
+        assert(!read_only_);
+        Header().size = size;
+    }
+
+    void MapFile() {
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            ThrowSystemError("fstat");
+        }
+
+        const bool fresh = st.st_size == 0;
+        if (fresh) {
+            if (read_only_) {
+                throw std::runtime_error("MappedVector: empty file opened read-only");
+            }
+            if (::ftruncate(fd_, FileBytes(0)) != 0) {
+                ThrowSystemError("ftruncate");
+            }
+            st.st_size = FileBytes(0);
+        } else if (static_cast<size_t>(st.st_size) < sizeof(MappedVectorHeader)) {
+            throw std::runtime_error("MappedVector: file is too short for a header");
+        }
+
+        const int prot = read_only_ ? PROT_READ : PROT_READ | PROT_WRITE;
+        void *p = ::mmap(nullptr, st.st_size, prot, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        base_ = p;
+        mapped_bytes_ = st.st_size;
+
+        if (fresh) {
+            Header() = {MappedVectorHeader::kMagic, MappedVectorHeader::kFormatVersion, SchemaVersion,
+                        sizeof(T), alignof(T), 0, 0};
+        }
+        CheckHeader();
+    }
+
+    void CheckHeader() const {
+        const auto &header = Header();
+        if (header.magic != MappedVectorHeader::kMagic) {
+            throw std::runtime_error("MappedVector: not a MappedVector file");
+        }
+        if (header.format_version != MappedVectorHeader::kFormatVersion || header.schema_version != SchemaVersion) {
+            throw std::runtime_error("MappedVector: version mismatch");
+        }
+        if (header.element_size != sizeof(T) || header.element_align != alignof(T)) {
+            throw std::runtime_error("MappedVector: element layout mismatch");
+        }
+        if (header.size > header.capacity || mapped_bytes_ < FileBytes(header.capacity)) {
+            throw std::runtime_error("MappedVector: file is truncated");
+        }
+    }
+
+    // Меняет длину файла под new_capacity элементов и переотображает его. При неудаче прежнее
+    // отображение и длина файла сохраняются
+    void Remap(size_t new_capacity) {
+        assert(!read_only_);
+        assert(new_capacity >= Size());
+        const size_t new_bytes = FileBytes(new_capacity);
+        const size_t old_bytes = mapped_bytes_;
+
+        if (new_bytes > old_bytes && ::ftruncate(fd_, new_bytes) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        void *p = ::mremap(base_, old_bytes, new_bytes, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            const int error = errno;
+            if (new_bytes > old_bytes) {
+                [[maybe_unused]] int rolled_back = ::ftruncate(fd_, old_bytes);
+            }
+            throw std::system_error(error, std::generic_category(), "mremap");
+        }
+        base_ = p;
+        mapped_bytes_ = new_bytes;
+        Header().capacity = new_capacity;
+
+        if (new_bytes < old_bytes) {
+            [[maybe_unused]] int truncated = ::ftruncate(fd_, new_bytes);
+        }
+    }
+
+    void Close() noexcept {
+        if (base_ != nullptr) {
+            ::munmap(base_, mapped_bytes_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+};
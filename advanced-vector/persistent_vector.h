@@ -0,0 +1,490 @@
+#pragma once
+#include "inplace_vector.h"
+#include "vector.h"
+
+#include <array>
+#include <atomic>
+
+// Неизменяемый вектор с разделением структуры: PushBack, Set и PopBack возвращают новую версию,
+// которая делит со старой все незатронутые куски. Элементы лежат непрерывными кусками по kChunk
+// в листьях префиксного дерева ширины 32 (как у вектора Clojure), последний кусок — отдельно в
+// хвосте, поэтому PushBack обычно копирует только хвост, а Set — один лист и log32(n) узлов.
+// Тысячи версий таблицы в миллион элементов обходятся в несколько килобайт на версию.
+//
+// Для пакетных изменений есть Transient: он меняет на месте узлы, которыми владеет один, и копирует
+// только разделяемые с другими версиями. Версии и переходы между режимами стоят O(1), а ToVector
+// собирает обычный Vector за O(n).
+//
+// Версии можно читать и порождать из разных потоков одновременно: узлы, видимые из нескольких
+// версий, никогда не меняются
+template <typename T, typename Allocator = std::allocator<T>>
+class PersistentVector {
+    static constexpr unsigned kBits = 5;
+
+    class Iterator;
+
+public:
+    static constexpr size_t kChunk = size_t{1} << kBits;
+
+    class Transient;
+
+    using value_type = T;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    const_iterator begin() const noexcept {
+        return {&trie_, 0};
+    }
+
+    const_iterator end() const noexcept {
+        return {&trie_, trie_.size};
+    }
+
+    PersistentVector() = default;
+
+    explicit PersistentVector(const Allocator &alloc) noexcept : trie_(alloc) {
+    }
+
+    // Собирает вектор из диапазона за O(n), дописывая в Transient
+    template <std::input_iterator InputIt>
+    PersistentVector(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+        : PersistentVector(Collect(first, last, alloc)) {
+    }
+
+    size_t Size() const noexcept {
+        return trie_.size;
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        assert(index < trie_.size);
+        return trie_.ChunkFor(index)[index & kMask];
+    }
+
+    const T &Back() const noexcept {
+        return (*this)[trie_.size - 1];
+    }
+
+    // Новая версия с value в конце
+    [[nodiscard]] PersistentVector PushBack(T value) const {
+        PersistentVector next(*this);
+        next.trie_.PushBack(std::move(value));
+        return next;
+    }
+
+    // Новая версия с value в позиции index
+    [[nodiscard]] PersistentVector Set(size_t index, T value) const {
+        assert(index < trie_.size);
+        PersistentVector next(*this);
+        next.trie_.Set(index, std::move(value));
+        return next;
+    }
+
+    // Новая версия без последнего элемента
+    [[nodiscard]] PersistentVector PopBack() const {
+        assert(trie_.size > 0);
+        PersistentVector next(*this);
+        next.trie_.PopBack();
+        return next;
+    }
+
+    // Изменяемая копия для пакета изменений. Эта версия остаётся прежней
+    Transient AsTransient() const & {
+        return Transient(trie_);
+    }
+
+    Transient AsTransient() && noexcept {
+        return Transient(std::move(trie_));
+    }
+
+    // Вызывает f(std::span<const T>) для каждого куска по порядку
+    template <typename F>
+    void ForEachChunk(F &&f) const {
+        trie_.ForEachChunk(f);
+    }
+
+    Vector<T, Allocator> ToVector() const {
+        return trie_.ToVector();
+    }
+
+private:
+    static constexpr size_t kMask = kChunk - 1;
+
+    using Leaf = InplaceVector<T, kChunk>;
+
+    // Дети узла уровня kBits — листья, остальных — узлы. Тип ребёнка определяется уровнем, поэтому
+    // ссылки хранятся без типа
+    struct Branch {
+        std::array<std::shared_ptr<void>, kChunk> children;
+    };
+
+    // Общая часть постоянного вектора и Transient. Изменяющие операции копируют узел, только если
+    // на него ссылается кто-то ещё, поэтому постоянные операции работают на копии trie_, а
+    // Transient — на своём trie_ и меняет на месте всё, чем владеет один
+    struct Trie {
+        [[no_unique_address]] Allocator alloc;
+        std::shared_ptr<Branch> root;
+        std::shared_ptr<Leaf> tail;
+        size_t size = 0;
+        // Уровень корня: индекс ребёнка корня — биты [shift, shift + kBits) индекса элемента
+        unsigned shift = kBits;
+
+        Trie() = default;
+
+        explicit Trie(const Allocator &alloc) noexcept : alloc(alloc) {
+        }
+
+        // Первый индекс хвоста
+        size_t TailOffset() const noexcept {
+            return size < kChunk ? 0 : (size - 1) & ~kMask;
+        }
+
+        // Начало куска, в котором лежит элемент index
+        const T *ChunkFor(size_t index) const noexcept {
+            if (index >= TailOffset()) {
+                return tail->Data();
+            }
+            const void *node = root.get();
+            for (unsigned level = shift; level > 0; level -= kBits) {
+                node = static_cast<const Branch *>(node)->children[(index >> level) & kMask].get();
+            }
+            return static_cast<const Leaf *>(node)->Data();
+        }
+
+        void PushBack(T &&value) {
+            if (tail && size - TailOffset() < kChunk) {
+                MakeUnique(tail).PushBack(std::move(value));
+                ++size;
+                return;
+            }
+
+            // Новый хвост строится первым: если бросит, дерево не тронуто
+            auto new_tail = std::allocate_shared<Leaf>(alloc);
+            new_tail->PushBack(std::move(value));
+            if (tail) {
+                PushTail();
+            }
+            tail = std::move(new_tail);
+            ++size;
+        }
+
+        void Set(size_t index, T &&value) {
+            if (index >= TailOffset()) {
+                MakeUnique(tail)[index & kMask] = std::move(value);
+                return;
+            }
+            Branch *node = &MakeUnique(root);
+            for (unsigned level = shift; level > kBits; level -= kBits) {
+                node = &MakeUniqueSlot<Branch>(node->children[(index >> level) & kMask]);
+            }
+            MakeUniqueSlot<Leaf>(node->children[(index >> kBits) & kMask])[index & kMask] = std::move(value);
+        }
+
+        void PopBack() {
+            if (size == 1) {
+                root.reset();
+                tail.reset();
+                size = 0;
+                shift = kBits;
+                return;
+            }
+            if (size - TailOffset() > 1) {
+                MakeUnique(tail).PopBack();
+                --size;
+                return;
+            }
+
+            // В хвосте остался один элемент: хвостом становится последний лист дерева
+            std::shared_ptr<Leaf> new_tail = LeafSlot(size - 2);
+            Branch &new_root = MakeUnique(root);
+            PopTail(shift, new_root);
+            if (size - 1 <= kChunk) {
+                root.reset();
+            } else if (shift > kBits && !new_root.children[1]) {
+                root = std::static_pointer_cast<Branch>(new_root.children[0]);
+                shift -= kBits;
+            }
+            tail = std::move(new_tail);
+            --size;
+        }
+
+        template <typename F>
+        void ForEachChunk(F &f) const {
+            if (root) {
+                ForEachChunk(f, root.get(), shift);
+            }
+            if (tail) {
+                f(std::span<const T>(tail->Data(), tail->Size()));
+            }
+        }
+
+        Vector<T, Allocator> ToVector() const {
+            Vector<T, Allocator> result(alloc);
+            result.Reserve(size);
+            auto append = [&result](std::span<const T> chunk) { result.Append(chunk); };
+            ForEachChunk(append);
+            return result;
+        }
+
+    private:
+        static void SynchronizeWithReleases() noexcept {
+            // Счётчик читается без упорядочения: прежде чем менять узел, синхронизируемся с
+            // освобождением его другими версиями
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+
+        template <typename Node>
+        Node &MakeUnique(std::shared_ptr<Node> &node) {
+            if (node.use_count() != 1) {
+                node = std::allocate_shared<Node>(alloc, std::as_const(*node));
+            } else {
+                SynchronizeWithReleases();
+            }
+            return *node;
+        }
+
+        // То же для ссылки без типа. static_pointer_cast здесь не годится: он увеличил бы счётчик
+        template <typename Node>
+        Node &MakeUniqueSlot(std::shared_ptr<void> &slot) {
+            if (slot.use_count() != 1) {
+                slot = std::allocate_shared<Node>(alloc, std::as_const(*static_cast<const Node *>(slot.get())));
+            } else {
+                SynchronizeWithReleases();
+            }
+            return *static_cast<Node *>(slot.get());
+        }
+
+        std::shared_ptr<Leaf> LeafSlot(size_t index) const {
+            const Branch *node = root.get();
+            for (unsigned level = shift; level > kBits; level -= kBits) {
+                node = static_cast<const Branch *>(node->children[(index >> level) & kMask].get());
+            }
+            return std::static_pointer_cast<Leaf>(node->children[(index >> kBits) & kMask]);
+        }
+
+        // Цепочка из узлов с единственным ребёнком от уровня level до листа leaf
+        std::shared_ptr<void> NewPath(unsigned level, std::shared_ptr<void> leaf) {
+            if (level == 0) {
+                return leaf;
+            }
+            auto branch = std::allocate_shared<Branch>(alloc);
+            branch->children[0] = NewPath(level - kBits, std::move(leaf));
+            return branch;
+        }
+
+        // Переносит заполненный хвост в дерево, при необходимости добавляя уровень
+        void PushTail() {
+            if (!root) {
+                auto new_root = std::allocate_shared<Branch>(alloc);
+                new_root->children[0] = tail;
+                root = std::move(new_root);
+            } else if ((size >> kBits) > (size_t{1} << shift)) {
+                auto new_root = std::allocate_shared<Branch>(alloc);
+                new_root->children[1] = NewPath(shift, tail);
+                new_root->children[0] = std::move(root);
+                root = std::move(new_root);
+                shift += kBits;
+            } else {
+                PushTail(shift, MakeUnique(root));
+            }
+        }
+
+        void PushTail(unsigned level, Branch &parent) {
+            auto &child = parent.children[((size - 1) >> level) & kMask];
+            if (level == kBits) {
+                child = tail;
+            } else if (child) {
+                PushTail(level - kBits, MakeUniqueSlot<Branch>(child));
+            } else {
+                child = NewPath(level - kBits, tail);
+            }
+        }
+
+        // Убирает из поддерева лист с элементом size - 2. Возвращает, опустел ли node
+        bool PopTail(unsigned level, Branch &node) {
+            const size_t sub = ((size - 2) >> level) & kMask;
+            auto &child = node.children[sub];
+            if (level == kBits || PopTail(level - kBits, MakeUniqueSlot<Branch>(child))) {
+                child.reset();
+            }
+            return sub == 0 && !child;
+        }
+
+        template <typename F>
+        static void ForEachChunk(F &f, const void *node, unsigned level) {
+            if (level == 0) {
+                const Leaf &leaf = *static_cast<const Leaf *>(node);
+                f(std::span<const T>(leaf.Data(), leaf.Size()));
+                return;
+            }
+            for (const auto &child : static_cast<const Branch *>(node)->children) {
+                if (!child) {
+                    break;
+                }
+                ForEachChunk(f, child.get(), level - kBits);
+            }
+        }
+    };
+
+    Trie trie_;
+
+    explicit PersistentVector(Trie &&trie) noexcept : trie_(std::move(trie)) {
+    }
+
+    template <typename InputIt>
+    static PersistentVector Collect(InputIt first, InputIt last, const Allocator &alloc) {
+        Transient transient{PersistentVector(alloc).AsTransient()};
+        for (; first != last; ++first) {
+            transient.PushBack(*first);
+        }
+        return std::move(transient).Persistent();
+    }
+};
+
+// Изменяемый на месте вид PersistentVector. Узлы, которые он разделяет с другими версиями,
+// копируются при первом изменении, дальше меняются без копирования
+template <typename T, typename Allocator>
+class PersistentVector<T, Allocator>::Transient {
+public:
+    size_t Size() const noexcept {
+        return trie_.size;
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        assert(index < trie_.size);
+        return trie_.ChunkFor(index)[index & kMask];
+    }
+
+    void PushBack(T value) {
+        trie_.PushBack(std::move(value));
+    }
+
+    void Set(size_t index, T value) {
+        assert(index < trie_.size);
+        trie_.Set(index, std::move(value));
+    }
+
+    void PopBack() {
+        assert(trie_.size > 0);
+        trie_.PopBack();
+    }
+
+    // Превращает накопленное в постоянную версию за O(1)
+    PersistentVector Persistent() && noexcept {
+        return PersistentVector(std::move(trie_));
+    }
+
+    Vector<T, Allocator> ToVector() const {
+        return trie_.ToVector();
+    }
+
+private:
+    friend class PersistentVector;
+
+    Trie trie_;
+
+    explicit Transient(const Trie &trie) : trie_(trie) {
+    }
+
+    explicit Transient(Trie &&trie) noexcept : trie_(std::move(trie)) {
+    }
+};
+
+// Итератор помнит начало текущего куска и спускается по дереву только при переходе в следующий
+template <typename T, typename Allocator>
+class PersistentVector<T, Allocator>::Iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    Iterator() = default;
+
+    Iterator(const Trie *trie, size_t index) noexcept : trie_(trie), index_(index) {
+        LoadChunk();
+    }
+
+    reference operator*() const noexcept {
+        return chunk_[index_ & kMask];
+    }
+
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return *(*this + n);
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        if ((index_ & kMask) == 0) {
+            LoadChunk();
+        }
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        Iterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        if ((index_ & kMask) == kMask) {
+            LoadChunk();
+        }
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        Iterator old = *this;
+        --*this;
+        return old;
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        LoadChunk();
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        return *this += -n;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    const Trie *trie_ = nullptr;
+    size_t index_ = 0;
+    const T *chunk_ = nullptr;
+
+    void LoadChunk() noexcept {
+        chunk_ = index_ < trie_->size ? trie_->ChunkFor(index_) : nullptr;
+    }
+};
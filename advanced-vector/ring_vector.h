@@ -0,0 +1,410 @@
+#pragma once
+#include "vector.h"
+
+// Кольцевой буфер на RawMemory: PushFront, PopFront, PushBack и PopBack работают за амортизированное
+// O(1), поэтому очередь не сдвигает все элементы на каждом извлечении, как Vector::Erase(begin()).
+// Элементы занимают [head, head + size) по модулю вместимости и могут переходить через конец буфера.
+// Segments() отдаёт их двумя непрерывными кусками (например, для writev), а Linearize() собирает
+// в один.
+//
+// Рост следует правилам Vector::Reserve: элементы переносятся memcpy, если тип тривиально
+// перемещаем, перемещением, если оно не бросает исключений, и копированием иначе, так что при
+// исключении очередь остаётся прежней
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class RingVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    template <bool Const>
+    class Iterator;
+
+public:
+    using value_type = T;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using allocator_type = Allocator;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    RingVector() = default;
+
+    explicit RingVector(const Allocator &alloc) noexcept : data_(alloc) {
+    }
+
+    RingVector(const RingVector &other)
+        : data_(other.size_, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        other.TransferTo(data_.GetAddress(), [](T *first, size_t n, T *dst) { std::uninitialized_copy_n(first, n, dst); });
+        size_ = other.size_;
+    }
+
+    RingVector(RingVector &&other) noexcept
+        : data_(std::move(other.data_)), head_(std::exchange(other.head_, 0)), size_(std::exchange(other.size_, 0)) {
+    }
+
+    RingVector &operator=(const RingVector &rhs) {
+        if (this != &rhs) {
+            RingVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    RingVector &operator=(RingVector &&rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            data_ = std::move(rhs.data_);
+            head_ = std::exchange(rhs.head_, 0);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~RingVector() {
+        Clear();
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        return const_cast<RingVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[Physical(index)];
+    }
+
+    T &Front() noexcept {
+        return (*this)[0];
+    }
+
+    const T &Front() const noexcept {
+        return (*this)[0];
+    }
+
+    T &Back() noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    const T &Back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Без propagate_on_container_swap обмен допустим только для равных аллокаторов
+    void Swap(RingVector &other) noexcept {
+        data_.Swap(other.data_);
+        std::swap(head_, other.head_);
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > data_.Capacity()) {
+            RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+            RelocateTo(new_data.GetAddress());
+            data_.Swap(new_data);
+            head_ = 0;
+        }
+    }
+
+    void Clear() noexcept {
+        const auto [first, second] = Segments();
+        std::destroy(first.begin(), first.end());
+        std::destroy(second.begin(), second.end());
+        head_ = 0;
+        size_ = 0;
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PushFront(const T &value) {
+        EmplaceFront(value);
+    }
+
+    void PushFront(T &&value) {
+        EmplaceFront(std::move(value));
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        if (size_ == data_.Capacity()) [[unlikely]] {
+            // Новый элемент строится в новом буфере раньше, чем переносятся старые: args могут
+            // ссылаться на них
+            RawMemory<T, Allocator> new_data(NextCapacity(), data_.GetAllocator());
+            T *value = std::construct_at(new_data + size_, std::forward<Args>(args)...);
+            Regrow(new_data, value, 0);
+        } else {
+            std::construct_at(data_ + Physical(size_), std::forward<Args>(args)...);
+        }
+        ++size_;
+        return Back();
+    }
+
+    template <typename... Args>
+    T &EmplaceFront(Args &&...args) {
+        if (size_ == data_.Capacity()) [[unlikely]] {
+            // В новом буфере элемент ставится в последнюю ячейку, а старые — с начала: следующие
+            // PushFront займут место перед ним, а PushBack — после старых
+            RawMemory<T, Allocator> new_data(NextCapacity(), data_.GetAllocator());
+            const size_t new_head = new_data.Capacity() - 1;
+            T *value = std::construct_at(new_data + new_head, std::forward<Args>(args)...);
+            Regrow(new_data, value, new_head);
+        } else {
+            head_ = Prev(head_);
+            std::construct_at(data_ + head_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return Front();
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(data_ + Physical(size_));
+        if (size_ == 0) {
+            head_ = 0;
+        }
+    }
+
+    void PopFront() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(data_ + head_);
+        --size_;
+        // В пустой очереди голова возвращается в начало, и данные снова лежат одним куском
+        head_ = size_ == 0 ? 0 : Next(head_);
+    }
+
+    // Элементы по порядку двумя непрерывными кусками; второй пуст, если кольцо не переходит через
+    // конец буфера
+    std::pair<std::span<T>, std::span<T>> Segments() noexcept {
+        const size_t first_size = std::min(size_, data_.Capacity() - head_);
+        return {{data_ + head_, first_size}, {data_ + 0, size_ - first_size}};
+    }
+
+    std::pair<std::span<const T>, std::span<const T>> Segments() const noexcept {
+        const auto [first, second] = const_cast<RingVector &>(*this).Segments();
+        return {first, second};
+    }
+
+    // Укладывает элементы подряд с начала буфера и возвращает их одним куском. Тривиально
+    // перемещаемые элементы сдвигаются на месте поворотом буфера, остальные переносятся в новый
+    // буфер той же вместимости. Если элементы уже лежат подряд, ничего не делает
+    std::span<T> Linearize() {
+        if (head_ + size_ > data_.Capacity()) {
+            if constexpr (is_trivially_relocatable_v<T>) {
+                // Поворачивается весь буфер вместе с незанятыми ячейками: для тривиально
+                // перемещаемых T это просто байты
+                auto *bytes = reinterpret_cast<std::byte *>(data_.GetAddress());
+                std::rotate(bytes, bytes + head_ * sizeof(T), bytes + data_.Capacity() * sizeof(T));
+            } else {
+                RawMemory<T, Allocator> new_data(data_.Capacity(), data_.GetAllocator());
+                RelocateTo(new_data.GetAddress());
+                data_.Swap(new_data);
+            }
+            head_ = 0;
+        }
+        return {data_ + head_, size_};
+    }
+
+    friend bool operator==(const RingVector &lhs, const RingVector &rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    RawMemory<T, Allocator> data_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    // Позиция в буфере элемента index; index == size_ даёт ячейку для PushBack
+    size_t Physical(size_t index) const noexcept {
+        const size_t position = head_ + index;
+        return position < data_.Capacity() ? position : position - data_.Capacity();
+    }
+
+    size_t Next(size_t position) const noexcept {
+        return position + 1 == data_.Capacity() ? 0 : position + 1;
+    }
+
+    size_t Prev(size_t position) const noexcept {
+        return position == 0 ? data_.Capacity() - 1 : position - 1;
+    }
+
+    size_t NextCapacity() const noexcept {
+        return GrowthPolicy::template NextCapacity<T>(data_.Capacity(), size_ + 1);
+    }
+
+    // Строит в dst элементы по порядку, передавая оба куска в transfer(first, n, dst). Если второй
+    // кусок бросит, уже построенные из первого уничтожаются
+    template <typename Transfer>
+    void TransferTo(T *dst, Transfer transfer) const {
+        const auto [first, second] = const_cast<RingVector &>(*this).Segments();
+        transfer(first.data(), first.size(), dst);
+        try {
+            transfer(second.data(), second.size(), dst + first.size());
+        } catch (...) {
+            std::destroy_n(dst, first.size());
+            throw;
+        }
+    }
+
+    // Переносит элементы по порядку в неинициализированную память dst. Исходные уничтожаются,
+    // только когда все построены, поэтому при исключении очередь остаётся прежней
+    void RelocateTo(T *dst) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            const auto [first, second] = Segments();
+            detail::UninitializedRelocateN(first.data(), first.size(), dst);
+            detail::UninitializedRelocateN(second.data(), second.size(), dst + first.size());
+        } else {
+            TransferTo(dst, [](T *first, size_t n, T *dst) { detail::UninitializedMoveIfNoexceptN(first, n, dst); });
+            const auto [first, second] = Segments();
+            std::destroy(first.begin(), first.end());
+            std::destroy(second.begin(), second.end());
+        }
+    }
+
+    // Переносит элементы в new_data, где рядом с ними уже построен value, и делает его буфером.
+    // Если перенос бросит, value уничтожается, а очередь остаётся прежней
+    void Regrow(RawMemory<T, Allocator> &new_data, T *value, size_t new_head) {
+        try {
+            RelocateTo(new_data.GetAddress());
+        } catch (...) {
+            std::destroy_at(value);
+            throw;
+        }
+        data_.Swap(new_data);
+        head_ = new_head;
+    }
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+template <bool Const>
+class RingVector<T, Allocator, GrowthPolicy>::Iterator {
+    using Ring = std::conditional_t<Const, const RingVector, RingVector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    Iterator() = default;
+
+    Iterator(Ring *ring, size_t index) noexcept : ring_(ring), index_(index) {
+    }
+
+    // Изменяемый итератор приводится к константному
+    operator Iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return {ring_, index_};
+    }
+
+    reference operator*() const noexcept {
+        return (*ring_)[index_];
+    }
+
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return (*ring_)[index_ + n];
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        Iterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        Iterator old = *this;
+        --index_;
+        return old;
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Ring *ring_ = nullptr;
+    size_t index_ = 0;
+};
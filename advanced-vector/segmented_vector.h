@@ -0,0 +1,341 @@
+#pragma once
+#include "vector.h"
+
+// Вектор из цепочки блоков RawMemory вместимостью kFirstSegment, 2 * kFirstSegment,
+// 4 * kFirstSegment, ... Рост добавляет новый блок и не трогает старые, поэтому элементы никогда
+// не переезжают: адреса стабильны, а T не обязан уметь перемещаться, пока не понадобятся Insert
+// или Erase в середине. Индекс переводится в блок и смещение одним bit_width.
+// Insert и Erase сдвигают хвост присваиваниями, как Vector при достаточной вместимости, и дают
+// те же гарантии исключений
+template <typename T, typename Allocator = std::allocator<T>>
+class SegmentedVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    template <bool Const>
+    class Iterator;
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using allocator_type = Allocator;
+
+    // Первый блок занимает около 256 байт
+    static constexpr size_t kFirstSegment = std::bit_ceil(std::max<size_t>(256 / sizeof(T), 1));
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator &alloc) noexcept : alloc_(alloc) {
+    }
+
+    explicit SegmentedVector(size_t size, const Allocator &alloc = Allocator()) : alloc_(alloc) {
+        Resize(size);
+    }
+
+    SegmentedVector(const SegmentedVector &other)
+        : SegmentedVector(other, AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    }
+
+    SegmentedVector(const SegmentedVector &other, const Allocator &alloc) : alloc_(alloc) {
+        Reserve(other.size_);
+        try {
+            for (const T &value : other) {
+                EmplaceBack(value);
+            }
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector &&other) noexcept
+        : alloc_(other.alloc_), segments_(std::move(other.segments_)), size_(std::exchange(other.size_, 0)) {
+    }
+
+    SegmentedVector &operator=(const SegmentedVector &rhs) {
+        if (this != &rhs) {
+            SegmentedVector rhs_copy(rhs, alloc_);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector &operator=(SegmentedVector &&rhs) noexcept {
+        if (this != &rhs) {
+            SegmentedVector rhs_moved(std::move(rhs));
+            Swap(rhs_moved);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return SegmentStart(segments_.Size());
+    }
+
+    // Аллокаторы обмениваются по тем же правилам, что и в RawMemory::Swap
+    void Swap(SegmentedVector &other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
+        segments_.Swap(other.segments_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Добавляет блоки, пока вместимость не станет не меньше new_capacity
+    void Reserve(size_t new_capacity) {
+        while (Capacity() < new_capacity) {
+            AddSegment();
+        }
+    }
+
+    // Освобождает блоки, в которых не осталось элементов
+    void ShrinkToFit() noexcept {
+        while (segments_.Size() != 0 && SegmentStart(segments_.Size() - 1) >= size_) {
+            segments_.PopBack();
+        }
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    // Уничтожает элементы, сохраняя блоки
+    void Clear() noexcept {
+        while (size_ != 0) {
+            PopBack();
+        }
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Существующие элементы не двигаются, поэтому аргументы могут ссылаться на них
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        if (size_ == Capacity()) {
+            AddSegment();
+        }
+        T *slot = std::construct_at(Slot(size_), std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(Slot(size_));
+    }
+
+    iterator Insert(const_iterator pos, const T &value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T &&value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args &&...args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t index = pos - cbegin();
+        if (index == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        T tmp_copy(std::forward<Args>(args)...);
+        EmplaceBack(std::move((*this)[size_ - 1]));
+        std::move_backward(begin() + index, end() - 2, end() - 1);
+        (*this)[index] = std::move(tmp_copy);
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+
+        if (count != 0) {
+            std::move(begin() + index + count, end(), begin() + index);
+            for (size_t i = 0; i < count; ++i) {
+                PopBack();
+            }
+        }
+        return begin() + index;
+    }
+
+private:
+    [[no_unique_address]] Allocator alloc_;
+    Vector<RawMemory<T, Allocator>> segments_;
+    size_t size_ = 0;
+
+    // Блок s начинается с индекса kFirstSegment * (2^s - 1)
+    static constexpr size_t SegmentStart(size_t segment) noexcept {
+        return kFirstSegment * ((size_t{1} << segment) - 1);
+    }
+
+    T *Slot(size_t index) noexcept {
+        const size_t segment = std::bit_width(index / kFirstSegment + 1) - 1;
+        return segments_[segment] + (index - SegmentStart(segment));
+    }
+
+    void AddSegment() {
+        segments_.EmplaceBack(kFirstSegment << segments_.Size(), alloc_);
+    }
+};
+
+// Итератор хранит индекс, а не указатель: переход через границу блока не требует проверок
+template <typename T, typename Allocator>
+template <bool Const>
+class SegmentedVector<T, Allocator>::Iterator {
+    using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    Iterator() = default;
+
+    Iterator(Owner *owner, size_t index) noexcept : owner_(owner), index_(index) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    operator Iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return {owner_, index_};
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return (*owner_)[index_ + n];
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        return {owner_, index_++};
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        return {owner_, index_--};
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Owner *owner_ = nullptr;
+    size_t index_ = 0;
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Неизменяемый снимок Vector с подсчётом ссылок: копирование SharedVector стоит O(1) и не трогает
+// элементы, сколько бы читателей ни держали один буфер. Писатель получает изменяемый Vector через
+// Mutable(); если буфер в этот момент делят с кем-то ещё, он сначала копируется, так что снимки
+// у других владельцев не меняются.
+//
+// Разные объекты SharedVector, делящие буфер, можно читать и изменять из разных потоков без
+// синхронизации. Один и тот же объект, как и обычный Vector, нельзя одновременно менять и читать
+// из разных потоков: для публикации снимков между потоками служит AtomicSharedVector
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename Instrumentation = NoInstrumentation>
+class SharedVector {
+public:
+    using Container = Vector<T, Allocator, GrowthPolicy, Instrumentation>;
+    using value_type = T;
+    using iterator = const T *;
+    using const_iterator = const T *;
+
+    iterator begin() const noexcept {
+        return Data();
+    }
+
+    iterator end() const noexcept {
+        return Data() + Size();
+    }
+
+    SharedVector() = default;
+
+    // Забирает буфер vector без копирования элементов
+    explicit SharedVector(Container &&vector)
+        : data_(std::allocate_shared<Container>(vector.GetAllocator(), std::move(vector))) {
+    }
+
+    const T *Data() const noexcept {
+        return data_ ? data_->Data() : nullptr;
+    }
+
+    size_t Size() const noexcept {
+        return data_ ? data_->Size() : 0;
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    // Делит ли этот объект буфер с другими
+    bool IsShared() const noexcept {
+        return data_.use_count() > 1;
+    }
+
+    // Vector для изменения. Если буфер общий, сначала делается собственная копия. Ссылка остаётся
+    // действительной, пока этот объект не скопирован и не изменён иначе: после копирования
+    // изменения через неё увидели бы и другие владельцы
+    Container &Mutable() {
+        if (!data_) {
+            data_ = std::allocate_shared<Container>(Allocator());
+        } else if (data_.use_count() > 1) {
+            data_ = std::allocate_shared<Container>(data_->GetAllocator(), *data_);
+        } else {
+            // Счётчик читается без упорядочения: синхронизируемся с освобождением буфера другими
+            // владельцами, прежде чем менять то, что они могли читать
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data_;
+    }
+
+    // Забирает Vector, оставляя этот объект пустым. Копирует, только если буфер общий
+    Container Release() && {
+        std::shared_ptr<Container> data = std::move(data_);
+        if (!data) {
+            return Container();
+        }
+        if (data.use_count() > 1) {
+            return Container(*data);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return std::move(*data);
+    }
+
+    void Swap(SharedVector &other) noexcept {
+        data_.swap(other.data_);
+    }
+
+    friend bool operator==(const SharedVector &lhs, const SharedVector &rhs) {
+        return lhs.data_ == rhs.data_ || std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+private:
+    template <typename, typename, typename, typename>
+    friend class AtomicSharedVector;
+
+    std::shared_ptr<Container> data_;
+
+    explicit SharedVector(std::shared_ptr<Container> data) noexcept : data_(std::move(data)) {
+    }
+};
+
+// Превращает vector в неизменяемый снимок, не копируя элементы
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+SharedVector<T, Allocator, GrowthPolicy, Instrumentation> Freeze(
+    Vector<T, Allocator, GrowthPolicy, Instrumentation> &&vector) {
+    return SharedVector<T, Allocator, GrowthPolicy, Instrumentation>(std::move(vector));
+}
+
+// Ячейка, через которую писатель атомарно публикует новый снимок, а читатели забирают текущий.
+// Load отдаёт читателю собственную ссылку на буфер: старый снимок живёт, пока его держит хоть один
+// читатель, даже после публикации нового
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename Instrumentation = NoInstrumentation>
+class AtomicSharedVector {
+public:
+    using Snapshot = SharedVector<T, Allocator, GrowthPolicy, Instrumentation>;
+
+    AtomicSharedVector() = default;
+
+    explicit AtomicSharedVector(Snapshot snapshot) noexcept : data_(std::move(snapshot.data_)) {
+    }
+
+    AtomicSharedVector(const AtomicSharedVector &) = delete;
+    AtomicSharedVector &operator=(const AtomicSharedVector &) = delete;
+
+    Snapshot Load() const noexcept {
+        return Snapshot(data_.load(std::memory_order_acquire));
+    }
+
+    void Store(Snapshot snapshot) noexcept {
+        data_.store(std::move(snapshot.data_), std::memory_order_release);
+    }
+
+    Snapshot Exchange(Snapshot snapshot) noexcept {
+        return Snapshot(data_.exchange(std::move(snapshot.data_), std::memory_order_acq_rel));
+    }
+
+    // Публикует desired, если текущий снимок — тот же буфер, что у expected. Иначе записывает
+    // в expected текущий снимок и возвращает false
+    bool CompareExchange(Snapshot &expected, Snapshot desired) noexcept {
+        return data_.compare_exchange_strong(expected.data_, std::move(desired.data_), std::memory_order_acq_rel,
+                                             std::memory_order_acquire);
+    }
+
+    // Применяет update(Vector &) к копии текущего снимка и публикует результат. Если другой писатель
+    // успел опубликовать свой снимок раньше, повторяет на нём, так что ни одно обновление не теряется
+    template <typename Operation>
+    void Update(Operation update) {
+        Snapshot current = Load();
+        while (true) {
+            Snapshot next = current;
+            update(next.Mutable());
+            if (CompareExchange(current, std::move(next))) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::atomic<std::shared_ptr<typename Snapshot::Container>> data_;
+};
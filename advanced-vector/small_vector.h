@@ -0,0 +1,245 @@
+#pragma once
+#include "vector.h"
+
+// Вектор, хранящий до N элементов прямо в объекте и уходящий в кучу, только когда их становится
+// больше. Семантика Emplace/Erase/Reserve и гарантии исключений те же, что у Vector
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class SmallVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(N > 0, "use Vector when no inline capacity is needed");
+
+public:
+    using iterator = T *;
+    using const_iterator = const T *;
+    using allocator_type = Allocator;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_cast<SmallVector &>(*this).Data();
+    }
+
+    const_iterator cend() const noexcept {
+        return cbegin() + size_;
+    }
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator &alloc) noexcept : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Allocator &alloc = Allocator()) : heap_(alloc) {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector &other)
+        : heap_(AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.begin(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    // Буфер из кучи забирается целиком, встроенные элементы переносятся по одному
+    SmallVector(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.GetAllocator()) {
+        if (other.IsInline()) {
+            detail::UninitializedRelocateN(other.Data(), other.size_, Data());
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            heap_ = std::move(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    SmallVector &operator=(const SmallVector &rhs) {
+        if (this != &rhs) {
+            if (rhs.size_ > Capacity()) {
+                SmallVector rhs_copy(rhs);
+                Swap(rhs_copy);
+            } else {
+                AssignFrom(rhs.begin(), rhs.size_);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                       && (AllocTraits::propagate_on_container_move_assignment::value
+                                                           || AllocTraits::is_always_equal::value)) {
+        if (this != &rhs) {
+            Clear();
+            if (!rhs.IsInline()
+                && (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value
+                    || GetAllocator() == rhs.GetAllocator())) {
+                heap_ = std::move(rhs.heap_);
+            } else {
+                Reserve(rhs.size_);
+                detail::UninitializedRelocateN(rhs.Data(), rhs.size_, Data());
+            }
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    const T &operator[](size_t index) const noexcept {
+        return const_cast<SmallVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы хранятся во встроенном буфере, а не в куче
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    void Swap(SmallVector &other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        detail::UninitializedRelocateN(Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+            size_ = new_size;
+        } else if (new_size > size_) {
+            Reserve(new_size);
+
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    // Уничтожает элементы, сохраняя вместимость
+    void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        return *Emplace(end(), std::forward<Args>(args)...);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        std::destroy_at(Data() + size_ - 1);
+        --size_;
+    }
+
+    iterator Insert(const_iterator pos, const T &value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T &&value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args &&...args) {
+        assert(pos >= cbegin() && pos <= cend());
+        size_t index = pos - cbegin();
+
+        if (size_ == Capacity()) {
+            RawMemory<T, Allocator> new_data(GrowthPolicy::template NextCapacity<T>(Capacity(), size_ + 1),
+                                             heap_.GetAllocator());
+            detail::EmplaceRelocating(Data(), size_, index, new_data.GetAddress(), std::forward<Args>(args)...);
+            heap_.Swap(new_data);
+        } else {
+            detail::EmplaceInPlace(Data(), size_, index, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+        return begin() + index;
+    }
+
+    iterator Erase(const_iterator pos) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= cbegin() && pos < cend());
+        size_t index = pos - cbegin();
+
+        detail::EraseAt(Data(), size_, index);
+        --size_;
+        return begin() + index;
+    }
+
+private:
+    // Пустой heap_ означает, что элементы лежат во встроенном буфере inline_
+    RawMemory<T, Allocator> heap_;
+    alignas(T) std::byte inline_[N * sizeof(T)];
+    size_t size_ = 0;
+
+    T *Data() noexcept {
+        return IsInline() ? reinterpret_cast<T *>(inline_) : heap_.GetAddress();
+    }
+
+    template <typename InputIt>
+    void AssignFrom(InputIt first, size_t count) {
+        assert(count <= Capacity());
+        std::copy_n(first, std::min(size_, count), Data());
+        if (count < size_) {
+            std::destroy_n(Data() + count, size_ - count);
+        } else {
+            std::uninitialized_copy_n(first + size_, count - size_, Data() + size_);
+        }
+        size_ = count;
+    }
+};
@@ -0,0 +1,378 @@
+#pragma once
+#include "vector.h"
+
+#include <tuple>
+
+// Вектор записей из полей Ts..., хранящий каждое поле в своём столбце: цикл по одному-двум полям
+// читает только их строки кэша, а столбцы выровнены по строке кэша, так что компилятор векторизует
+// такие циклы над Column<I>(). Все столбцы растут вместе с той же строгой гарантией, что и
+// Vector::Reserve. Итератор отдаёт прокси-ссылку std::tuple<Ts &...>, которую удобно разбирать
+// структурной привязкой:
+//
+//   SoAVector<float, float, int> particles;
+//   for (auto [x, y, id] : particles) { ... }
+template <typename... Ts>
+class SoAVector {
+    static_assert(sizeof...(Ts) > 0);
+
+    template <typename T>
+    using ColumnAllocator = AlignedAllocator<T, std::max(kCacheLineSize, alignof(T))>;
+
+    using Columns = std::tuple<RawMemory<Ts, ColumnAllocator<Ts>>...>;
+
+    template <bool Const>
+    class Iterator;
+
+public:
+    static constexpr size_t kColumns = sizeof...(Ts);
+
+    template <size_t I>
+    using ColumnType = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts &...>;
+    using const_reference = std::tuple<const Ts &...>;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    SoAVector() = default;
+
+    explicit SoAVector(size_t size) {
+        Resize(size);
+    }
+
+    SoAVector(const SoAVector &other) : columns_{RawMemory<Ts, ColumnAllocator<Ts>>(other.size_)...} {
+        CopyColumns<0>(other.columns_, other.size_);
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector &&other) noexcept
+        : columns_(std::move(other.columns_)), size_(std::exchange(other.size_, 0)) {
+    }
+
+    SoAVector &operator=(const SoAVector &rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector &operator=(SoAVector &&rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            columns_ = std::move(rhs.columns_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SoAVector() {
+        Clear();
+    }
+
+    // Столбец поля I целиком. Начало выровнено по строке кэша
+    template <size_t I>
+    std::span<ColumnType<I>> Column() noexcept {
+        return {std::assume_aligned<kCacheLineSize>(std::get<I>(columns_).GetAddress()), size_};
+    }
+
+    template <size_t I>
+    std::span<const ColumnType<I>> Column() const noexcept {
+        return {std::assume_aligned<kCacheLineSize>(std::get<I>(columns_).GetAddress()), size_};
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Row<reference>(columns_, index);
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Row<const_reference>(columns_, index);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    void Swap(SoAVector &other) noexcept {
+        [this, &other]<size_t... I>(std::index_sequence<I...>) {
+            (std::get<I>(columns_).Swap(std::get<I>(other.columns_)), ...);
+        }(std::index_sequence_for<Ts...>{});
+        std::swap(size_, other.size_);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Reallocate<false>(new_capacity, [](Columns &, size_t) {});
+        }
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack(Ts()...);
+        }
+    }
+
+    void Clear() noexcept {
+        while (size_ != 0) {
+            PopBack();
+        }
+    }
+
+    void PushBack(const Ts &...values) {
+        EmplaceBack(values...);
+    }
+
+    // Принимает по одному аргументу на столбец. Аргументы могут ссылаться на элементы этого же
+    // вектора: при переразмещении новая запись строится раньше, чем старые переезжают
+    template <typename... Args>
+        requires(sizeof...(Args) == kColumns)
+    reference EmplaceBack(Args &&...args) {
+        auto construct = [&](Columns &columns, size_t index) {
+            ConstructRow<0>(columns, index, std::forward_as_tuple(std::forward<Args>(args)...));
+        };
+        if (size_ == Capacity()) {
+            Reallocate<true>(DoublingGrowth::NextCapacity<value_type>(Capacity(), size_ + 1), construct);
+        } else {
+            construct(columns_, size_);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::apply([this](auto &...columns) { (std::destroy_at(columns + size_), ...); }, columns_);
+    }
+
+    iterator Erase(const_iterator pos) noexcept((... && (is_trivially_relocatable_v<Ts>
+                                                         || std::is_nothrow_move_assignable_v<Ts>))) {
+        assert(pos >= cbegin() && pos < cend());
+        const size_t index = pos - cbegin();
+        std::apply([this, index](auto &...columns) { (detail::EraseAt(columns.GetAddress(), size_, index), ...); },
+                   columns_);
+        --size_;
+        return begin() + index;
+    }
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+
+    template <typename Reference, typename ColumnTuple>
+    static Reference Row(ColumnTuple &columns, size_t index) noexcept {
+        return std::apply([index](auto &...column) { return Reference(column[index]...); }, columns);
+    }
+
+    // Строит запись index из аргументов args по столбцам. Если столбец I бросил, уже построенные
+    // поля этой записи уничтожаются
+    template <size_t I, typename ArgsTuple>
+    static void ConstructRow(Columns &columns, size_t index, ArgsTuple &&args) {
+        if constexpr (I < kColumns) {
+            std::construct_at(std::get<I>(columns) + index, std::get<I>(std::forward<ArgsTuple>(args)));
+            try {
+                ConstructRow<I + 1>(columns, index, std::forward<ArgsTuple>(args));
+            } catch (...) {
+                std::destroy_at(std::get<I>(columns) + index);
+                throw;
+            }
+        }
+    }
+
+    template <size_t I>
+    void CopyColumns(const Columns &source, size_t count) {
+        if constexpr (I < kColumns) {
+            detail::UninitializedCopyN(std::get<I>(source).GetAddress(), count, std::get<I>(columns_).GetAddress());
+            try {
+                CopyColumns<I + 1>(source, count);
+            } catch (...) {
+                std::destroy_n(std::get<I>(columns_).GetAddress(), count);
+                throw;
+            }
+        }
+    }
+
+    // Столбцы, которые при переезде придётся копировать: только они могут бросить
+    template <typename T>
+    static constexpr bool kCopiedOnRelocation = !is_trivially_relocatable_v<T>
+                                                && !std::is_nothrow_move_constructible_v<T>
+                                                && std::is_copy_constructible_v<T>;
+
+    // Копирует в new_columns только бросающие столбцы. При исключении уничтожает сделанные копии
+    template <size_t I>
+    void CopyThrowingColumns(Columns &new_columns) {
+        if constexpr (I < kColumns) {
+            if constexpr (kCopiedOnRelocation<ColumnType<I>>) {
+                std::uninitialized_copy_n(std::get<I>(columns_).GetAddress(), size_,
+                                          std::get<I>(new_columns).GetAddress());
+                try {
+                    CopyThrowingColumns<I + 1>(new_columns);
+                } catch (...) {
+                    std::destroy_n(std::get<I>(new_columns).GetAddress(), size_);
+                    throw;
+                }
+            } else {
+                CopyThrowingColumns<I + 1>(new_columns);
+            }
+        }
+    }
+
+    // Переносит все столбцы в буферы вместимостью new_capacity. При kWithRow сначала строит в них
+    // запись size_ вызовом construct(new_columns, size_). Всё, что может бросить, — выделение,
+    // construct и копирование бросающих столбцов — выполняется до того, как тронуты старые элементы
+    template <bool kWithRow, typename Construct>
+    void Reallocate(size_t new_capacity, Construct construct) {
+        Columns new_columns{RawMemory<Ts, ColumnAllocator<Ts>>(new_capacity)...};
+        if constexpr (kWithRow) {
+            construct(new_columns, size_);
+        }
+        try {
+            CopyThrowingColumns<0>(new_columns);
+        } catch (...) {
+            if constexpr (kWithRow) {
+                std::apply([this](auto &...columns) { (std::destroy_at(columns + size_), ...); }, new_columns);
+            }
+            throw;
+        }
+
+        [this, &new_columns]<size_t... I>(std::index_sequence<I...>) {
+            (RelocateOrDestroy<I>(new_columns), ...);
+        }(std::index_sequence_for<Ts...>{});
+        columns_.swap(new_columns);
+    }
+
+    // Бросающие столбцы уже скопированы: остаётся уничтожить оригиналы. Остальные переносятся
+    template <size_t I>
+    void RelocateOrDestroy(Columns &new_columns) noexcept {
+        auto *old_data = std::get<I>(columns_).GetAddress();
+        if constexpr (kCopiedOnRelocation<ColumnType<I>>) {
+            std::destroy_n(old_data, size_);
+        } else {
+            detail::UninitializedRelocateN(old_data, size_, std::get<I>(new_columns).GetAddress());
+        }
+    }
+};
+
+// Итератор хранит индекс записи и при разыменовании собирает прокси-ссылку из всех столбцов
+template <typename... Ts>
+template <bool Const>
+class SoAVector<Ts...>::Iterator {
+    using Owner = std::conditional_t<Const, const SoAVector, SoAVector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<Ts...>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const_reference, SoAVector::reference>;
+
+    Iterator() = default;
+
+    Iterator(Owner *owner, size_t index) noexcept : owner_(owner), index_(index) {
+    }
+
+    // Неконстантный итератор неявно приводится к константному
+    operator Iterator<true>() const noexcept
+        requires(!Const)
+    {
+        return {owner_, index_};
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    reference operator[](difference_type n) const noexcept {
+        return (*owner_)[index_ + n];
+    }
+
+    Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+        return {owner_, index_++};
+    }
+
+    Iterator &operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+        return {owner_, index_--};
+    }
+
+    Iterator &operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    Iterator &operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator+(difference_type n, Iterator it) noexcept {
+        return it += n;
+    }
+
+    friend Iterator operator-(Iterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const Iterator &lhs, const Iterator &rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Owner *owner_ = nullptr;
+    size_t index_ = 0;
+};
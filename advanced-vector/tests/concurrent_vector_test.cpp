@@ -0,0 +1,96 @@
+#include "concurrent_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kProducers = 8;
+constexpr int kPerProducer = 20000;
+
+// Несколько писателей и читатель одновременно: каждый элемент добавлен ровно один раз, ссылки
+// стабильны, а читатель видит только построенные элементы
+TEST(ConcurrentVectorTest, MultiProducerStress) {
+    ConcurrentVector<std::string> vector;
+    std::atomic<bool> done{false};
+
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            vector.ForEach([](size_t, const std::string &value) {
+                ASSERT_FALSE(value.empty());
+            });
+        }
+    });
+
+    std::vector<std::vector<const std::string *>> returned(kProducers);
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < kProducers; ++producer) {
+        producers.emplace_back([&, producer] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                returned[producer].push_back(&vector.EmplaceBack(std::to_string(producer * kPerProducer + i)));
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    ASSERT_EQ(vector.Size(), static_cast<size_t>(kProducers * kPerProducer));
+    std::vector<int> seen(kProducers * kPerProducer, 0);
+    vector.ForEach([&](size_t index, const std::string &value) {
+        EXPECT_EQ(&vector[index], &value);
+        ++seen[std::stoi(value)];
+    });
+    for (int count : seen) {
+        ASSERT_EQ(count, 1);
+    }
+    // Ссылки, возвращённые EmplaceBack, не переехали и указывают на элементы своего писателя
+    for (int producer = 0; producer < kProducers; ++producer) {
+        for (int i = 0; i < kPerProducer; ++i) {
+            ASSERT_EQ(*returned[producer][i], std::to_string(producer * kPerProducer + i));
+        }
+    }
+}
+
+struct ThrowsOnSeven {
+    explicit ThrowsOnSeven(int value) : value(value) {
+        if (value % 1000 == 7) {
+            throw std::runtime_error("seven");
+        }
+    }
+
+    int value;
+};
+
+// Брошенный конструктор оставляет дыру, которую пропускают TryGet и ForEach
+TEST(ConcurrentVectorTest, ThrowingConstructorLeavesHole) {
+    ConcurrentVector<ThrowsOnSeven> vector;
+    vector.Reserve(3000);
+    size_t thrown = 0;
+    for (int i = 0; i < 3000; ++i) {
+        try {
+            vector.EmplaceBack(i);
+        } catch (const std::runtime_error &) {
+            ++thrown;
+        }
+    }
+    EXPECT_EQ(thrown, 3u);
+    EXPECT_EQ(vector.Size(), 3000u);
+    EXPECT_EQ(vector.TryGet(7), nullptr);
+    ASSERT_NE(vector.TryGet(8), nullptr);
+    EXPECT_EQ(vector.TryGet(8)->value, 8);
+    EXPECT_EQ(vector.TryGet(3000), nullptr);
+
+    size_t built = 0;
+    vector.ForEach([&](size_t, const ThrowsOnSeven &) {
+        ++built;
+    });
+    EXPECT_EQ(built, 3000u - thrown);
+}
+
+}  // namespace
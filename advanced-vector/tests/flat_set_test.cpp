@@ -0,0 +1,161 @@
+#include "flat_map.h"
+#include "flat_set.h"
+#include "test_types.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Сравнение по значению, которое бросает, когда заканчивается бюджет вызовов
+struct ThrowingLess {
+    static inline int budget = -1;
+
+    template <typename T>
+    bool operator()(const T &lhs, const T &rhs) const {
+        if (budget == 0) {
+            throw std::runtime_error("ThrowingLess: budget exhausted");
+        }
+        if (budget > 0) {
+            --budget;
+        }
+        return Key(lhs) < Key(rhs);
+    }
+
+    static int Key(int value) {
+        return value;
+    }
+
+    template <bool kMoveMayThrow>
+    static int Key(const Counted<kMoveMayThrow> &value) {
+        return value.Value();
+    }
+};
+
+class FlatInsertRangeTest : public CountedTest {
+protected:
+    void TearDown() override {
+        ThrowingLess::budget = -1;
+        CountedTest::TearDown();
+    }
+};
+
+template <typename Set>
+bool IsSortedUnique(const Set &set) {
+    return std::adjacent_find(set.begin(), set.end(), [](const auto &lhs, const auto &rhs) {
+               return !ThrowingLess()(lhs, rhs);
+           }) == set.end();
+}
+
+// Пары чередуются со старыми ключами, поэтому идёт настоящее слияние, а не дописывание в конец
+const std::vector<int> kOld{0, 10, 20, 30, 40, 50, 60, 70};
+const std::vector<int> kBatch{65, 5, 35, 10, 15, 5, 75, 25};
+
+TEST_F(FlatInsertRangeTest, SetComparatorThrowLeavesSetIntact) {
+    for (int budget = 0; budget < 200; ++budget) {
+        FlatSet<int, ThrowingLess> set;
+        set.InsertRange(kOld.begin(), kOld.end());
+        ThrowingLess::budget = budget;
+        try {
+            set.InsertRange(kBatch.begin(), kBatch.end());
+            ThrowingLess::budget = -1;
+            EXPECT_EQ(set.Size(), 14u);
+        } catch (const std::runtime_error &) {
+            ThrowingLess::budget = -1;
+            EXPECT_EQ(std::vector<int>(set.begin(), set.end()), kOld) << "budget " << budget;
+        }
+        ASSERT_TRUE(IsSortedUnique(set)) << "budget " << budget;
+        EXPECT_TRUE(set.Contains(40));
+    }
+}
+
+TEST_F(FlatInsertRangeTest, SetCopyThrowLeavesSetIntact) {
+    std::vector<ThrowingMove> batch;
+    for (int key : kBatch) {
+        batch.emplace_back(key);
+    }
+    for (int budget = 0; budget < 40; ++budget) {
+        FlatSet<ThrowingMove, ThrowingLess> set;
+        for (int key : kOld) {
+            set.Insert(ThrowingMove(key));
+        }
+        ThrowingMove::budget = budget;
+        try {
+            set.InsertRange(batch.begin(), batch.end());
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(set.Size(), 14u);
+        } catch (const std::runtime_error &) {
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(Values(set), kOld) << "budget " << budget;
+        }
+        ASSERT_TRUE(IsSortedUnique(set)) << "budget " << budget;
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(set.Size() + batch.size()));
+    }
+}
+
+template <typename Map>
+std::vector<std::pair<int, int>> Pairs(const Map &map) {
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto &[key, value] : map) {
+        pairs.emplace_back(ThrowingLess::Key(key), ThrowingLess::Key(value));
+    }
+    return pairs;
+}
+
+TEST_F(FlatInsertRangeTest, MapComparatorThrowLeavesMapIntact) {
+    std::vector<std::pair<int, int>> old_pairs;
+    for (int key : kOld) {
+        old_pairs.emplace_back(key, -key);
+    }
+    std::vector<std::pair<int, int>> batch;
+    for (int key : kBatch) {
+        batch.emplace_back(key, key);
+    }
+    for (int budget = 0; budget < 200; ++budget) {
+        FlatMap<int, int, ThrowingLess> map;
+        map.InsertRange(old_pairs.begin(), old_pairs.end());
+        ThrowingLess::budget = budget;
+        try {
+            map.InsertRange(batch.begin(), batch.end());
+            ThrowingLess::budget = -1;
+            EXPECT_EQ(map.Size(), 14u);
+            EXPECT_EQ(map.At(10), -10);
+        } catch (const std::runtime_error &) {
+            ThrowingLess::budget = -1;
+            EXPECT_EQ(Pairs(map), old_pairs) << "budget " << budget;
+        }
+        ASSERT_TRUE(std::is_sorted(map.begin(), map.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.first < rhs.first;
+        }));
+    }
+}
+
+// Ключи перемещаются без исключений, а копирование значения бросает: уже перемещённые ключи
+// должны вернуться на место
+TEST_F(FlatInsertRangeTest, MapValueCopyThrowRestoresMovedKeys) {
+    std::vector<std::pair<ThrowingCopy, ThrowingMove>> batch;
+    for (int key : kBatch) {
+        batch.emplace_back(ThrowingCopy(key), ThrowingMove(key));
+    }
+    for (int budget = 0; budget < 40; ++budget) {
+        FlatMap<ThrowingCopy, ThrowingMove, ThrowingLess> map;
+        for (int key : kOld) {
+            map.TryEmplace(ThrowingCopy(key), -key);
+        }
+        const auto old_pairs = Pairs(map);
+        ThrowingMove::budget = budget;
+        try {
+            map.InsertRange(batch.begin(), batch.end());
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(map.Size(), 14u);
+        } catch (const std::runtime_error &) {
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(Pairs(map), old_pairs) << "budget " << budget;
+        }
+        EXPECT_EQ(ThrowingCopy::live, static_cast<int>(map.Size() + batch.size()));
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(map.Size() + batch.size()));
+    }
+}
+
+}  // namespace
@@ -0,0 +1,30 @@
+#include "inplace_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <type_traits>
+
+namespace {
+
+// Таблица, заполненная не до конца, остаётся константой: незанятые ячейки при компиляции обнуляются
+constexpr auto kPartialTable = [] {
+    InplaceVector<int, 16> squares;
+    for (int i = 0; i < 5; ++i) {
+        squares.PushBack(i * i);
+    }
+    return squares;
+}();
+
+static_assert(kPartialTable.Size() == 5 && kPartialTable[4] == 16);
+static_assert(std::is_trivially_copyable_v<InplaceVector<int, 16>>);
+
+TEST(InplaceVectorTest, PartialConstexprTableIsUsableAtRuntime) {
+    InplaceVector<int, 16> copy = kPartialTable;
+    ASSERT_EQ(copy.Size(), 5u);
+    EXPECT_EQ(copy[3], 9);
+    copy.PushBack(25);
+    EXPECT_EQ(copy.Size(), 6u);
+    EXPECT_EQ(copy[5], 25);
+}
+
+}  // namespace
@@ -0,0 +1,59 @@
+#include "mapped_vector.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+class MappedVectorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = std::filesystem::path(::testing::TempDir()) / "mapped_vector_test.bin";
+        std::filesystem::remove(path_);
+        MappedVector<int> vector(path_);
+        for (int i = 0; i < 100; ++i) {
+            vector.PushBack(i);
+        }
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path_);
+    }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(MappedVectorTest, ReadOnlyMapIsReadableThroughConst) {
+    const MappedVector<int> vector(path_, MapMode::kReadOnly);
+    ASSERT_EQ(vector.Size(), 100u);
+    EXPECT_EQ(vector[42], 42);
+    EXPECT_EQ(std::accumulate(vector.begin(), vector.end(), 0), 4950);
+}
+
+// Запись в отображение PROT_READ падала бы с SIGSEGV даже в сборке без assert
+TEST_F(MappedVectorTest, ReadOnlyMapRejectsEveryMutation) {
+    MappedVector<int> vector(path_, MapMode::kReadOnly);
+    const auto &view = std::as_const(vector);
+
+    EXPECT_THROW(vector[0] = 1, std::logic_error);
+    EXPECT_THROW(vector.Data(), std::logic_error);
+    EXPECT_THROW(vector.begin(), std::logic_error);
+    EXPECT_THROW(vector.end(), std::logic_error);
+    EXPECT_THROW(vector.PushBack(1), std::logic_error);
+    EXPECT_THROW(vector.EmplaceBack(1), std::logic_error);
+    EXPECT_THROW(vector.Insert(view.begin(), 1), std::logic_error);
+    EXPECT_THROW(vector.Erase(view.begin()), std::logic_error);
+    EXPECT_THROW(vector.PopBack(), std::logic_error);
+    EXPECT_THROW(vector.Clear(), std::logic_error);
+    EXPECT_THROW(vector.Resize(5), std::logic_error);
+    EXPECT_THROW(vector.Reserve(1000), std::logic_error);
+    EXPECT_THROW(vector.ShrinkToFit(), std::logic_error);
+
+    EXPECT_EQ(view.Size(), 100u);
+    EXPECT_EQ(view[0], 0);
+}
+
+}  // namespace
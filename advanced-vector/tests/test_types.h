@@ -0,0 +1,100 @@
+#pragma once
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+// Элемент, который считает живые экземпляры и бросает из копирования, а при kMoveMayThrow и из
+// перемещения, когда заканчивается бюджет операций. По счётчику видно, не утёк ли объект после
+// исключения
+template <bool kMoveMayThrow>
+class Counted {
+public:
+    static inline int live = 0;
+    // Сколько копирований и перемещений пройдут до исключения; -1 — без ограничений
+    static inline int budget = -1;
+
+    explicit Counted(int value = 0) noexcept : value_(value) {
+        ++live;
+    }
+
+    Counted(const Counted &other) : value_(other.value_) {
+        Spend();
+        ++live;
+    }
+
+    Counted(Counted &&other) noexcept(!kMoveMayThrow) : value_(other.value_) {
+        if constexpr (kMoveMayThrow) {
+            Spend();
+        }
+        other.value_ = kMovedFrom;
+        ++live;
+    }
+
+    Counted &operator=(const Counted &rhs) {
+        Spend();
+        value_ = rhs.value_;
+        return *this;
+    }
+
+    Counted &operator=(Counted &&rhs) noexcept(!kMoveMayThrow) {
+        if constexpr (kMoveMayThrow) {
+            Spend();
+        }
+        value_ = rhs.value_;
+        rhs.value_ = kMovedFrom;
+        return *this;
+    }
+
+    ~Counted() {
+        --live;
+    }
+
+    int Value() const noexcept {
+        return value_;
+    }
+
+    static constexpr int kMovedFrom = -1;
+
+private:
+    int value_;
+
+    static void Spend() {
+        if (budget == 0) {
+            throw std::runtime_error("Counted: budget exhausted");
+        }
+        if (budget > 0) {
+            --budget;
+        }
+    }
+};
+
+// Копирование может бросить, перемещение — нет
+using ThrowingCopy = Counted<false>;
+// Бросают и копирование, и перемещение
+using ThrowingMove = Counted<true>;
+
+// Сбрасывает счётчики перед тестом и проверяет после него, что ни один объект не утёк
+class CountedTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ThrowingCopy::live = ThrowingMove::live = 0;
+        ThrowingCopy::budget = ThrowingMove::budget = -1;
+    }
+
+    void TearDown() override {
+        ThrowingCopy::budget = ThrowingMove::budget = -1;
+        EXPECT_EQ(ThrowingCopy::live, 0);
+        EXPECT_EQ(ThrowingMove::live, 0);
+    }
+};
+
+// Значения элементов контейнера по порядку
+template <typename Container>
+std::vector<int> Values(const Container &container) {
+    std::vector<int> values;
+    for (const auto &element : container) {
+        values.push_back(element.Value());
+    }
+    return values;
+}
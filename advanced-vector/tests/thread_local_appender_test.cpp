@@ -0,0 +1,82 @@
+#include "thread_local_appender.h"
+#include "test_types.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kThreads = 4;
+constexpr int kPerThread = 50;
+
+template <typename Element>
+void Fill(ThreadLocalAppender<Element> &appender) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&appender, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                appender.EmplaceBack(t * kPerThread + i);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+template <typename Element>
+std::vector<int> SortedValues(const Vector<Element> &vector) {
+    std::vector<int> values = Values(vector);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+std::vector<int> Expected(int prefix) {
+    std::vector<int> values(prefix, 1000);
+    for (int i = 0; i < kThreads * kPerThread; ++i) {
+        values.push_back(i);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+using MergeIntoTest = CountedTest;
+
+TEST_F(MergeIntoTest, MovesAllChunksInParallel) {
+    ThreadLocalAppender<ThrowingCopy> appender;
+    Fill(appender);
+    Vector<ThrowingCopy> target;
+    target.EmplaceBack(1000);
+    appender.MergeInto(target);
+    EXPECT_EQ(SortedValues(target), Expected(1));
+    EXPECT_EQ(appender.Size(), 0u);
+}
+
+// Перемещение может бросить, поэтому куски копируются: исключение на любой копии не меняет ни
+// target, ни куски
+TEST_F(MergeIntoTest, ThrowingMoveGivesStrongGuarantee) {
+    ThreadLocalAppender<ThrowingMove> appender;
+    Fill(appender);
+    const size_t total = kThreads * kPerThread;
+
+    Vector<ThrowingMove> target;
+    target.EmplaceBack(1000);
+    target.EmplaceBack(1000);
+    for (const int budget : {0, 1, 50, 120, 199}) {
+        ThrowingMove::budget = budget;
+        EXPECT_THROW(appender.MergeInto(target), std::runtime_error) << "budget " << budget;
+        ThrowingMove::budget = -1;
+        EXPECT_EQ(Values(target), (std::vector<int>{1000, 1000}));
+        EXPECT_EQ(appender.Size(), total);
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(total + target.Size()));
+    }
+
+    const size_t capacity = target.Capacity();
+    appender.MergeInto(target);
+    EXPECT_EQ(SortedValues(target), Expected(2));
+    EXPECT_EQ(target.Capacity(), capacity);
+    EXPECT_EQ(appender.Size(), 0u);
+}
+
+}  // namespace
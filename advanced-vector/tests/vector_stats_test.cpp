@@ -0,0 +1,40 @@
+#include "vector_stats.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace {
+
+struct StatsTag {
+    static constexpr std::string_view kName = "vector_stats_test";
+};
+
+using Stats = CountingInstrumentation<StatsTag>;
+using CountedVector = Vector<int, std::allocator<int>, DoublingGrowth, Stats>;
+
+TEST(VectorStatsTest, ResetKeepsPeaks) {
+    {
+        CountedVector vector;
+        for (int i = 0; i < 100; ++i) {
+            vector.PushBack(i);
+        }
+    }
+    const auto before = Stats::Stats().Read();
+    ASSERT_GT(before.allocations, 0u);
+    ASSERT_EQ(before.peak_size, 100u);
+
+    Stats::Stats().Reset();
+    const auto after = Stats::Stats().Read();
+    EXPECT_EQ(after.allocations, 0u);
+    EXPECT_EQ(after.bytes_allocated, 0u);
+    EXPECT_EQ(after.relocated_bitwise + after.relocated_moved + after.relocated_copied, 0u);
+    EXPECT_EQ(after.peak_size, before.peak_size);
+    EXPECT_EQ(after.peak_capacity, before.peak_capacity);
+
+    Stats::Stats().ResetPeaks();
+    EXPECT_EQ(Stats::Stats().Read().peak_size, 0u);
+    EXPECT_EQ(Stats::Stats().Read().peak_capacity, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,133 @@
+#include "vector.h"
+#include "small_vector.h"
+#include "test_types.h"
+
+namespace {
+
+template <typename Container>
+Container Iota(int count, size_t capacity) {
+    Container container;
+    container.Reserve(capacity);
+    for (int i = 0; i < count; ++i) {
+        container.EmplaceBack(i);
+    }
+    return container;
+}
+
+using VectorInsertTest = CountedTest;
+
+// Копирование бросает раньше, чем хвост сдвинут: вектор не меняется
+TEST_F(VectorInsertTest, InsertCopyThrowLeavesVectorIntact) {
+    auto vector = Iota<Vector<ThrowingCopy>>(5, 16);
+    const ThrowingCopy value(42);
+    ThrowingCopy::budget = 0;
+    EXPECT_THROW(vector.Insert(vector.begin() + 1, value), std::runtime_error);
+    EXPECT_EQ(Values(vector), (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(ThrowingCopy::live, 6);
+
+    ThrowingCopy::budget = -1;
+    vector.Insert(vector.begin() + 1, value);
+    EXPECT_EQ(Values(vector), (std::vector<int>{0, 42, 1, 2, 3, 4}));
+}
+
+TEST_F(VectorInsertTest, EmplaceNoAliasCopyThrowLeavesVectorIntact) {
+    auto vector = Iota<Vector<ThrowingCopy>>(5, 16);
+    const ThrowingCopy value(42);
+    ThrowingCopy::budget = 0;
+    EXPECT_THROW(vector.EmplaceNoAlias(vector.begin(), value), std::runtime_error);
+    EXPECT_EQ(Values(vector), (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+// Исключение на любом шаге сдвига не оставляет лишних объектов за концом вектора
+TEST_F(VectorInsertTest, InsertMoveThrowAtEveryStepDoesNotLeak) {
+    for (int budget = 0; budget < 8; ++budget) {
+        auto vector = Iota<Vector<ThrowingMove>>(5, 16);
+        const ThrowingMove value(42);
+        ThrowingMove::budget = budget;
+        try {
+            vector.Insert(vector.begin() + 1, value);
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(Values(vector), (std::vector<int>{0, 42, 1, 2, 3, 4}));
+        } catch (const std::runtime_error &) {
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(vector.Size(), 5u);
+        }
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(vector.Size()) + 1) << "budget " << budget;
+    }
+}
+
+TEST_F(VectorInsertTest, EmplaceAliasingMoveThrowDoesNotLeak) {
+    for (int budget = 0; budget < 8; ++budget) {
+        auto vector = Iota<Vector<ThrowingMove>>(5, 16);
+        ThrowingMove::budget = budget;
+        try {
+            vector.Emplace(vector.begin(), vector[3]);
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(Values(vector), (std::vector<int>{3, 0, 1, 2, 3, 4}));
+        } catch (const std::runtime_error &) {
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(vector.Size(), 5u);
+        }
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(vector.Size())) << "budget " << budget;
+    }
+}
+
+TEST_F(VectorInsertTest, SmallVectorInsertDoesNotLeak) {
+    for (int budget = 0; budget < 8; ++budget) {
+        auto vector = Iota<SmallVector<ThrowingMove, 8>>(5, 8);
+        const ThrowingMove value(42);
+        ThrowingMove::budget = budget;
+        try {
+            vector.Insert(vector.begin() + 2, value);
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(Values(vector), (std::vector<int>{0, 1, 42, 2, 3, 4}));
+        } catch (const std::runtime_error &) {
+            ThrowingMove::budget = -1;
+            EXPECT_EQ(vector.Size(), 5u);
+        }
+        EXPECT_EQ(ThrowingMove::live, static_cast<int>(vector.Size()) + 1) << "budget " << budget;
+    }
+}
+
+using VectorInsertRangeTest = CountedTest;
+
+// Вставка в середину, когда хвост длиннее диапазона, и когда короче. На каждом шаге исключение не
+// оставляет объектов за концом вектора
+TEST_F(VectorInsertRangeTest, ThrowAtEveryStepDoesNotLeak) {
+    for (const size_t index : {1u, 4u}) {
+        for (int budget = 0; budget < 12; ++budget) {
+            auto vector = Iota<Vector<ThrowingMove>>(6, 16);
+            const std::vector<ThrowingMove> values{ThrowingMove(40), ThrowingMove(41), ThrowingMove(42)};
+            ThrowingMove::budget = budget;
+            try {
+                vector.Insert(vector.begin() + index, values.begin(), values.end());
+                ThrowingMove::budget = -1;
+                EXPECT_EQ(vector.Size(), 9u);
+                EXPECT_EQ(vector[index].Value(), 40);
+            } catch (const std::runtime_error &) {
+                ThrowingMove::budget = -1;
+                EXPECT_EQ(vector.Size(), 6u);
+            }
+            EXPECT_EQ(ThrowingMove::live, static_cast<int>(vector.Size() + values.size()))
+                << "index " << index << ", budget " << budget;
+        }
+    }
+}
+
+TEST_F(VectorInsertRangeTest, RepeatedValueThrowDoesNotLeak) {
+    for (int budget = 0; budget < 12; ++budget) {
+        auto vector = Iota<Vector<ThrowingCopy>>(6, 16);
+        ThrowingCopy::budget = budget;
+        try {
+            vector.Insert(vector.begin() + 2, 3, ThrowingCopy(7));
+            ThrowingCopy::budget = -1;
+            EXPECT_EQ(Values(vector), (std::vector<int>{0, 1, 7, 7, 7, 2, 3, 4, 5}));
+        } catch (const std::runtime_error &) {
+            ThrowingCopy::budget = -1;
+            EXPECT_EQ(vector.Size(), 6u);
+        }
+        EXPECT_EQ(ThrowingCopy::live, static_cast<int>(vector.Size())) << "budget " << budget;
+    }
+}
+
+}  // namespace
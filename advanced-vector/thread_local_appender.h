@@ -0,0 +1,185 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace detail {
+
+// Уникальный номер экземпляра: по адресу нельзя, на месте разрушенного объекта может оказаться новый
+inline std::uint64_t NextAppenderId() noexcept {
+    static std::atomic<std::uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+// Буфер для параллельного сбора результатов: каждый поток дописывает в свой Vector без
+// синхронизации, а MergeInto один раз резервирует место в итоговом векторе и переносит в него все
+// куски, параллельно, если T переносится без исключений, и для тривиально перемещаемых T через memcpy.
+// Добавления не должны пересекаться с MergeInto, Size и разрушением
+template <typename T, typename Allocator = std::allocator<T>>
+class ThreadLocalAppender {
+public:
+    ThreadLocalAppender() = default;
+
+    explicit ThreadLocalAppender(const Allocator &alloc) : alloc_(alloc) {
+    }
+
+    ThreadLocalAppender(const ThreadLocalAppender &) = delete;
+    ThreadLocalAppender &operator=(const ThreadLocalAppender &) = delete;
+
+    // Кусок текущего потока. Первое обращение потока берёт мьютекс, дальше ссылка достаётся из
+    // thread_local кэша
+    Vector<T, Allocator> &Local() {
+        LocalCache &cache = Cache();
+        if (cache.appender_id != id_) {
+            cache.items = &FindOrCreateChunk();
+            cache.appender_id = id_;
+        }
+        return *cache.items;
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        return Local().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Суммарное количество элементов во всех кусках
+    size_t Size() const {
+        std::lock_guard lock(mutex_);
+        size_t total = 0;
+        for (const auto &chunk : chunks_) {
+            total += chunk->items.Size();
+        }
+        return total;
+    }
+
+    // Дописывает элементы всех кусков в конец target по порядку кусков и опустошает куски,
+    // сохраняя их вместимость. Место в target резервируется один раз по его GrowthPolicy. Если T
+    // переносится без исключений, куски переносятся параллельно. Иначе они копируются по одному и
+    // опустошаются, только когда скопированы все. В обоих случаях при исключении ни target, ни
+    // куски не меняются. Исключение — T, который только перемещается, и перемещение может бросить:
+    // тогда гарантия базовая
+    template <typename GrowthPolicy, typename Instrumentation>
+    void MergeInto(Vector<T, Allocator, GrowthPolicy, Instrumentation> &target, const parallel_t &policy = parallel) {
+        std::lock_guard lock(mutex_);
+
+        Vector<size_t> ends;
+        ends.Reserve(chunks_.Size());
+        size_t total = 0;
+        for (const auto &chunk : chunks_) {
+            total += chunk->items.Size();
+            ends.PushBack(total);
+        }
+        if (total == 0) {
+            return;
+        }
+
+        const size_t old_size = target.Size();
+        if (total > target.Capacity() - old_size) {
+            target.Reserve(GrowthPolicy::template NextCapacity<T>(target.Capacity(),
+                                                                  detail::SaturatingAdd(old_size, total)));
+        }
+
+        if constexpr (is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) {
+            target.ResizeAndOverwrite(old_size + total, [&](T *data, size_t new_size) {
+                detail::ParallelConstructN(data + old_size, total, policy, [&](T *dst, size_t offset, size_t count) {
+                    RelocateOut(ends, offset, count, dst);
+                });
+                return new_size;
+            });
+
+            // Элементы уже перенесены: остаётся объявить куски пустыми, ничего не уничтожая
+            for (auto &chunk : chunks_) {
+                chunk->items.ResizeAndOverwrite(chunk->items.Size(), [](T *, size_t) { return size_t{0}; });
+            }
+        } else {
+            // Место уже есть, так что вставка в конец не переразмещает target, а бросить может только
+            // конструктор T. Уже добавленные элементы стоят в конце и удаляются без сдвигов
+            try {
+                for (auto &chunk : chunks_) {
+                    auto &items = chunk->items;
+                    if constexpr (std::is_copy_constructible_v<T>) {
+                        target.Insert(target.end(), items.begin(), items.end());
+                    } else {
+                        target.Insert(target.end(), std::make_move_iterator(items.begin()),
+                                      std::make_move_iterator(items.end()));
+                    }
+                }
+            } catch (...) {
+                target.Erase(target.begin() + old_size, target.end());
+                throw;
+            }
+            for (auto &chunk : chunks_) {
+                chunk->items.Clear();
+            }
+        }
+    }
+
+private:
+    // Куски лежат в отдельных блоках по строке кэша, чтобы потоки не делили строки заголовков
+    struct alignas(kCacheLineSize) Chunk {
+        Chunk(std::thread::id owner, const Allocator &alloc) : owner(owner), items(alloc) {
+        }
+
+        std::thread::id owner;
+        Vector<T, Allocator> items;
+    };
+
+    struct LocalCache {
+        std::uint64_t appender_id = 0;
+        Vector<T, Allocator> *items = nullptr;
+    };
+
+    const std::uint64_t id_ = detail::NextAppenderId();
+    [[no_unique_address]] Allocator alloc_;
+    mutable std::mutex mutex_;
+    Vector<std::unique_ptr<Chunk>> chunks_;
+
+    // Один слот на поток и на тип: поток, пишущий попеременно в два буфера одного типа, каждый
+    // раз будет искать свой кусок под мьютексом
+    static LocalCache &Cache() noexcept {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    Vector<T, Allocator> &FindOrCreateChunk() {
+        const auto self = std::this_thread::get_id();
+        std::lock_guard lock(mutex_);
+        for (auto &chunk : chunks_) {
+            if (chunk->owner == self) {
+                return chunk->items;
+            }
+        }
+        auto chunk = std::make_unique<Chunk>(self, alloc_);
+        auto &items = chunk->items;
+        chunks_.PushBack(std::move(chunk));
+        return items;
+    }
+
+    // Переносит элементы [offset, offset + count) общей нумерации кусков в dst. ends[i] — конец
+    // куска i в этой нумерации
+    void RelocateOut(const Vector<size_t> &ends, size_t offset, size_t count, T *dst) noexcept {
+        size_t chunk = std::upper_bound(ends.begin(), ends.end(), offset) - ends.begin();
+        while (count != 0) {
+            const size_t begin = chunk == 0 ? 0 : ends[chunk - 1];
+            const size_t n = std::min(count, ends[chunk] - offset);
+            detail::UninitializedRelocateN(chunks_[chunk]->items.Data() + (offset - begin), n, dst);
+            dst += n;
+            offset += n;
+            count -= n;
+            ++chunk;
+        }
+    }
+};
@@ -1,37 +1,547 @@
 #pragma once
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <concepts>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
+// Тип тривиально перемещаем, если перенос объекта на новый адрес с последующим «забыванием»
+// старого эквивалентен memcpy. Для своих типов-дескрипторов шаблон можно специализировать
 template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail {
+
+// Перемещает n элементов в неинициализированную память dst, если перемещение не бросает
+// исключений или копирование недоступно, иначе копирует их ради строгой гарантии
+template <typename T>
+void UninitializedMoveIfNoexceptN(T *first, size_t n, T *dst) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        std::uninitialized_move_n(first, n, dst);
+    } else {
+        std::uninitialized_copy_n(first, n, dst);
+    }
+}
+
+// Переносит n элементов из first в неинициализированную память dst, не пересекающуюся с исходной.
+// Исходные элементы после этого уничтожены
+template <typename T>
+void UninitializedRelocateN(T *first, size_t n, T *dst) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void *>(dst), static_cast<const void *>(first), n * sizeof(T));
+        }
+    } else {
+        UninitializedMoveIfNoexceptN(first, n, dst);
+        std::destroy_n(first, n);
+    }
+}
+
+// Сдвигает n тривиально перемещаемых элементов из first в dst; диапазоны могут пересекаться
+template <typename T>
+void RelocateOverlappingN(T *first, size_t n, T *dst) noexcept {
+    static_assert(is_trivially_relocatable_v<T>);
+    if (n != 0) {
+        std::memmove(static_cast<void *>(dst), static_cast<const void *>(first), n * sizeof(T));
+    }
+}
+
+// Указывает ли ссылка value внутрь массива [first, last), например на элемент или его поле
+template <typename T, typename U>
+bool PointsInto(const U &value, const T *first, const T *last) noexcept {
+    const void *address = std::addressof(value);
+    return !std::less<const void *>()(address, first) && std::less<const void *>()(address, last);
+}
+
+// Сдвигает [pos, last) на один элемент вправо, в неинициализированную ячейку last, и вызывает
+// assign(*pos). Если сдвиг или assign бросит, ячейка last уничтожается: в массиве остаются только
+// его прежние объекты, хотя часть из них может оказаться перемещённой (базовая гарантия)
+template <typename T, typename Assign>
+constexpr void ShiftRightAndAssign(T *pos, T *last, Assign &&assign) {
+    std::construct_at(last, std::move(*(last - 1)));
+    try {
+        std::move_backward(pos, last - 1, last);
+        assign(*pos);
+    } catch (...) {
+        std::destroy_at(last);
+        throw;
+    }
+}
+
+// Можно ли записать значение из args в уже сдвинутый массив без риска исключения
+template <typename T, typename... Args>
+inline constexpr bool kNothrowEmplaceAssign =
+    sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...)
+        ? (std::is_nothrow_assignable_v<T &, Args> && ...)
+        : std::is_nothrow_constructible_v<T, Args...> && std::is_nothrow_move_assignable_v<T>;
+
+// Как EmplaceInPlace, но args не ссылаются на элементы массива, поэтому временной копии можно
+// избежать. Тривиально перемещаемый хвост сдвигается одним memmove и при исключении из
+// конструктора возвращается обратно: гарантия строгая. Для остальных T значение пишется прямо
+// в сдвинутый массив, только если это не бросает, иначе сначала строится отдельно. Так исключение
+// из конструктора T ничего не меняет, а при исключении из перемещения хвоста гарантия базовая
+template <typename T, typename... Args>
+void EmplaceInPlaceNoAlias(T *first, size_t size, size_t index, Args &&...args) {
+    T *pos = first + index;
+    if (index == size) {
+        std::construct_at(pos, std::forward<Args>(args)...);
+        return;
+    }
+    if constexpr (is_trivially_relocatable_v<T>) {
+        RelocateOverlappingN(pos, size - index, pos + 1);
+        try {
+            std::construct_at(pos, std::forward<Args>(args)...);
+        } catch (...) {
+            RelocateOverlappingN(pos + 1, size - index, pos);
+            throw;
+        }
+    } else if constexpr (kNothrowEmplaceAssign<T, Args...>) {
+        ShiftRightAndAssign(pos, first + size, [&](T &slot) {
+            if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...)) {
+                slot = (std::forward<Args>(args), ...);
+            } else {
+                slot = T(std::forward<Args>(args)...);
+            }
+        });
+    } else {
+        T value(std::forward<Args>(args)...);
+        ShiftRightAndAssign(pos, first + size, [&](T &slot) {
+            slot = std::move(value);
+        });
+    }
+}
+
+// Создаёт элемент в позиции index массива [first, first + size), сдвигая хвост вправо.
+// За последним элементом должно быть место ещё под один. args могут ссылаться на элементы
+// массива: если это не исключено, значение сначала строится отдельно
+template <typename T, typename... Args>
+constexpr void EmplaceInPlace(T *first, size_t size, size_t index, Args &&...args) {
+    T *last = first + size;
+    if (index == size) {
+        std::construct_at(last, std::forward<Args>(args)...);
+        return;
+    }
+
+    // Сравнение адресов и memmove недоступны при компиляции
+    if (!std::is_constant_evaluated()) {
+        // Вставка готового T, лежащего вне массива, — частый случай, который проверяется дёшево
+        if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::remove_cvref_t<Args>, T> && ...)) {
+            if (!(PointsInto(args, first, last) || ...)) {
+                EmplaceInPlaceNoAlias(first, size, index, std::forward<Args>(args)...);
+                return;
+            }
+        }
+        if constexpr (is_trivially_relocatable_v<T>) {
+            alignas(T) std::byte slot[sizeof(T)];
+            T *value = std::construct_at(reinterpret_cast<T *>(slot), std::forward<Args>(args)...);
+            RelocateOverlappingN(first + index, size - index, first + index + 1);
+            UninitializedRelocateN(value, 1, first + index);
+            return;
+        }
+    }
+
+    T tmp_copy(std::forward<Args>(args)...);
+    ShiftRightAndAssign(first + index, last, [&](T &slot) {
+        slot = std::move(tmp_copy);
+    });
+}
+
+// Копирует n элементов из first в неинициализированную память dst. Непрерывные диапазоны
+// тривиально копируемых T копируются одним memcpy
+template <typename InputIt, typename T>
+void UninitializedCopyN(InputIt first, size_t n, T *dst) {
+    if constexpr (std::is_trivially_copyable_v<T> && std::contiguous_iterator<InputIt>
+                  && std::is_same_v<std::iter_value_t<InputIt>, T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void *>(dst), static_cast<const void *>(std::to_address(first)), n * sizeof(T));
+        }
+    } else {
+        std::uninitialized_copy_n(first, n, dst);
+    }
+}
+
+// Итератор, бесконечно повторяющий одно значение: вставка n копий идёт тем же путём, что и
+// вставка диапазона
+template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    RepeatIterator() = default;
+
+    explicit RepeatIterator(const T &value) noexcept : value_(&value) {
+    }
+
+    reference operator*() const noexcept {
+        return *value_;
+    }
+
+    RepeatIterator &operator++() noexcept {
+        return *this;
+    }
+
+    RepeatIterator operator++(int) noexcept {
+        return *this;
+    }
+
+    bool operator==(const RepeatIterator &) const = default;
+
+private:
+    const T *value_ = nullptr;
+};
+
+// Переносит size элементов из first в неинициализированный буфер dst, оставляя в позиции index
+// промежуток из gap ячеек. Если что-то бросит исключение, исходный массив не изменится,
+// а содержимое промежутка остаётся на совести вызывающего
+template <typename T>
+void RelocateAroundGap(T *first, size_t size, size_t index, T *dst, size_t gap) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        UninitializedRelocateN(first, index, dst);
+        UninitializedRelocateN(first + index, size - index, dst + index + gap);
+    } else {
+        // Исходные элементы уничтожаются только после того, как перенесены обе части
+        UninitializedMoveIfNoexceptN(first, index, dst);
+        try {
+            UninitializedMoveIfNoexceptN(first + index, size - index, dst + index + gap);
+        } catch (...) {
+            std::destroy_n(dst, index);
+            throw;
+        }
+        std::destroy_n(first, size);
+    }
+}
+
+// Создаёт элемент в позиции index неинициализированного буфера dst и переносит вокруг него
+// size элементов из first. Если что-то бросит исключение, исходный массив не изменится
+template <typename T, typename... Args>
+void EmplaceRelocating(T *first, size_t size, size_t index, T *dst, Args &&...args) {
+    std::construct_at(dst + index, std::forward<Args>(args)...);
+    try {
+        RelocateAroundGap(first, size, index, dst, 1);
+    } catch (...) {
+        std::destroy_at(dst + index);
+        throw;
+    }
+}
+
+// Вставляет count элементов из first в позицию index массива [first_elem, first_elem + size),
+// за которым есть место ещё под count элементов. Хвост сдвигается один раз. Для тривиально
+// перемещаемых T даёт строгую гарантию, иначе — базовую, как std::vector::insert: при исключении
+// объекты, уже созданные за прежним концом, уничтожаются
+template <typename T, typename ForwardIt>
+void InsertRangeInPlace(T *data, size_t size, size_t index, ForwardIt first, size_t count) {
+    T *pos = data + index;
+    const size_t elems_after = size - index;
+
+    if constexpr (is_trivially_relocatable_v<T>) {
+        RelocateOverlappingN(pos, elems_after, pos + count);
+        try {
+            UninitializedCopyN(first, count, pos);
+        } catch (...) {
+            RelocateOverlappingN(pos + count, elems_after, pos);
+            throw;
+        }
+    } else if (elems_after > count) {
+        T *last = data + size;
+        std::uninitialized_move(last - count, last, last);
+        try {
+            std::move_backward(pos, last - count, last);
+            std::copy_n(first, count, pos);
+        } catch (...) {
+            std::destroy_n(last, count);
+            throw;
+        }
+    } else {
+        ForwardIt mid = std::next(first, elems_after);
+        std::uninitialized_copy_n(mid, count - elems_after, data + size);
+        try {
+            std::uninitialized_move(pos, data + size, pos + count);
+        } catch (...) {
+            std::destroy_n(data + size, count - elems_after);
+            throw;
+        }
+        try {
+            std::copy_n(first, elems_after, pos);
+        } catch (...) {
+            std::destroy_n(data + size, count);
+            throw;
+        }
+    }
+}
+
+// Удаляет count элементов, начиная с index, из массива [first, first + size), сдвигая хвост
+// влево за один проход
+template <typename T>
+void EraseRange(T *first, size_t size, size_t index, size_t count) noexcept(is_trivially_relocatable_v<T>
+                                                                            || std::is_nothrow_move_assignable_v<T>) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::destroy_n(first + index, count);
+        RelocateOverlappingN(first + index + count, size - index - count, first + index);
+    } else {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::move(first + index + count, first + size, first + index);
+        } else {
+            std::copy(first + index + count, first + size, first + index);
+        }
+
+        std::destroy_n(first + size - count, count);
+    }
+}
+
+// Удаляет элемент index из массива [first, first + size), сдвигая хвост влево
+template <typename T>
+void EraseAt(T *first, size_t size, size_t index) noexcept(is_trivially_relocatable_v<T>
+                                                           || std::is_nothrow_move_assignable_v<T>) {
+    EraseRange(first, size, index, 1);
+}
+
+// Удаляет из массива [first, first + size) элементы, для которых pred вернул true, и записывает
+// в size новый размер. Выжившие элементы уплотняются за один проход, pred вызывается ровно один
+// раз на элемент. Если pred бросит исключение, массив останется без дыр
+template <typename T, typename Predicate>
+void CompactIf(T *first, size_t &size, Predicate &pred) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        // Подряд идущие выжившие элементы сдвигаются одним memmove
+        size_t read = 0;
+        size_t write = 0;
+        size_t run_begin = 0;
+        try {
+            while (read < size) {
+                run_begin = read;
+                while (read < size && !pred(first[read])) {
+                    ++read;
+                }
+                RelocateOverlappingN(first + run_begin, read - run_begin, first + write);
+                write += read - run_begin;
+                if (read < size) {
+                    std::destroy_at(first + read);
+                    ++read;
+                }
+            }
+        } catch (...) {
+            RelocateOverlappingN(first + run_begin, size - run_begin, first + write);
+            size = write + (size - run_begin);
+            throw;
+        }
+        size = write;
+    } else {
+        T *new_last = std::remove_if(first, first + size, std::ref(pred));
+        std::destroy(new_last, first + size);
+        size = new_last - first;
+    }
+}
+
+// Необязательные расширения аллокатора:
+//   bool try_expand(T *p, size_t n, size_t new_n) — расширяет блок на месте, не перемещая его;
+//   bool try_shrink(T *p, size_t n, size_t new_n) — возвращает хвост блока аллокатору на месте;
+//   T *reallocate(T *p, size_t n, size_t new_n) — переразмещает блок как realloc, сохраняя байты
+template <typename Allocator, typename T>
+concept AllocatorCanExpand = requires(Allocator &alloc, T *p, size_t n) {
+    { alloc.try_expand(p, n, n) } -> std::convertible_to<bool>;
+};
+
+template <typename Allocator, typename T>
+concept AllocatorCanShrink = requires(Allocator &alloc, T *p, size_t n) {
+    { alloc.try_shrink(p, n, n) } -> std::convertible_to<bool>;
+};
+
+template <typename Allocator, typename T>
+concept AllocatorCanReallocate = requires(Allocator &alloc, T *p, size_t n) {
+    { alloc.reallocate(p, n, n) } -> std::same_as<T *>;
+};
+
+// Выравнивание, которое аллокатор гарантирует своим блокам: Allocator::alignment, если он его
+// объявляет, иначе alignof(T)
+template <typename Allocator, typename T>
+inline constexpr size_t allocator_alignment_v = alignof(T);
+
+template <typename Allocator, typename T>
+    requires requires { Allocator::alignment; }
+inline constexpr size_t allocator_alignment_v<Allocator, T> = Allocator::alignment;
+
+constexpr size_t SaturatingAdd(size_t a, size_t b) noexcept {
+    return a > std::numeric_limits<size_t>::max() - b ? std::numeric_limits<size_t>::max() : a + b;
+}
+
+// Округляет размер блока вверх до класса размеров в духе jemalloc/mimalloc (nallocx):
+// шаг 16 байт до 64, дальше по четыре класса на каждую степень двойки
+constexpr size_t RoundUpToSizeClass(size_t bytes) noexcept {
+    if (bytes <= 16) {
+        return bytes <= 8 ? 8 : 16;
+    }
+    const size_t spacing = std::max<size_t>(std::bit_floor(bytes - 1) / 4, 16);
+    return (bytes + spacing - 1) / spacing * spacing;
+}
+
+}  // namespace detail
+
+// Аллокатор поверх malloc/free с переразмещением через realloc. Для больших блоков glibc
+// выполняет realloc через mremap, так что страницы не копируются и пик памяти не удваивается
+template <typename T>
+struct MallocAllocator {
+    using value_type = T;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not guarantee over-alignment");
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U> &) noexcept {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(NonNull(std::malloc(Bytes(n))));
+    }
+
+    void deallocate(T *p, size_t) noexcept {
+        std::free(p);
+    }
+
+    // При неудаче исходный блок остаётся нетронутым
+    T *reallocate(T *p, size_t, size_t new_n) {
+        return static_cast<T *>(NonNull(std::realloc(static_cast<void *>(p), Bytes(new_n))));
+    }
+
+    friend bool operator==(const MallocAllocator &, const MallocAllocator &) noexcept {
+        return true;
+    }
+
+private:
+    static size_t Bytes(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static void *NonNull(void *p) {
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+};
+
+// Аллокатор, выдающий блоки, выровненные по Alignment байт, через выровненный operator new.
+// Размер блока округляется вверх до кратного Alignment, поэтому при Alignment, равном строке кэша,
+// хвост вектора не делит строку с чужими данными. reallocate нет намеренно: realloc не сохраняет
+// выравнивание, так что при росте Vector всегда берёт новый выровненный блок
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    static constexpr size_t alignment = Alignment;
+
+    static_assert(std::has_single_bit(Alignment), "alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "alignment must not be weaker than alignof(T)");
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, std::max(Alignment, alignof(U))>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlignment> &) noexcept {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(::operator new(Bytes(n), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        ::operator delete(p, Bytes(n), std::align_val_t(Alignment));
+    }
+
+    friend bool operator==(const AlignedAllocator &, const AlignedAllocator &) noexcept {
+        return true;
+    }
+
+private:
+    static size_t Bytes(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - Alignment) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return (n * sizeof(T) + Alignment - 1) & ~(Alignment - 1);
+    }
+};
+
+// Размер строки кэша, по которому выравниваются буферы, разделяемые между потоками
+inline constexpr size_t kCacheLineSize = 64;
+
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+    using allocator_type = Allocator;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>, "Allocator::value_type must be T");
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity)), capacity_(capacity) {
+    explicit RawMemory(const Allocator &alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    explicit RawMemory(size_t capacity, const Allocator &alloc = Allocator())
+        : alloc_(alloc), buffer_(Allocate(capacity)), capacity_(capacity) {
     }
 
     RawMemory(const RawMemory &) = delete;
 
-    RawMemory(RawMemory &&other) noexcept {
-        Swap(other);
+    // Аллокатор переезжает вместе с буфером: освобождать память должен тот, кто её выделил
+    RawMemory(RawMemory &&other) noexcept
+        : alloc_(std::move(other.alloc_)),
+          buffer_(std::exchange(other.buffer_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)) {
     }
 
     RawMemory &operator=(const RawMemory &rhs) = delete;
 
+    // Забирает буфер other вместе с его аллокатором. Аллокаторы без присваивания
+    // (например, std::pmr::polymorphic_allocator) обязаны быть равны
     RawMemory &operator=(RawMemory &&other) noexcept {
         if (this != &other) {
-            Swap(other);
+            Deallocate(buffer_, capacity_);
+            if constexpr (std::is_move_assignable_v<Allocator>) {
+                alloc_ = std::move(other.alloc_);
+            } else {
+                assert(alloc_ == other.alloc_);
+            }
+            buffer_ = std::exchange(other.buffer_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
         }
         return *this;
     }
 
     ~RawMemory() {
-        Deallocate(buffer_);
+        Deallocate(buffer_, capacity_);
     }
 
     T *operator+(size_t offset) noexcept {
@@ -53,7 +563,15 @@ public:
         return buffer_[index];
     }
 
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap,
+    // иначе они должны быть равны, чтобы каждый буфер можно было освободить
     void Swap(RawMemory &other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
@@ -70,33 +588,249 @@ public:
         return capacity_;
     }
 
+    const Allocator &GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Пытается увеличить вместимость до new_capacity, не сдвигая буфер. Удаётся, только если
+    // аллокатор предоставляет try_expand и тот смог расширить блок на месте
+    bool TryExpand(size_t new_capacity) noexcept {
+        if constexpr (detail::AllocatorCanExpand<Allocator, T>) {
+            if (buffer_ != nullptr && new_capacity > capacity_
+                && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Пытается уменьшить вместимость до new_capacity, оставив буфер на месте и вернув хвост
+    // аллокатору. Удаётся, только если аллокатор предоставляет try_shrink
+    bool TryShrink(size_t new_capacity) noexcept {
+        if constexpr (detail::AllocatorCanShrink<Allocator, T>) {
+            if (buffer_ != nullptr && new_capacity != 0 && new_capacity < capacity_
+                && alloc_.try_shrink(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Переразмещает буфер под new_capacity элементов через reallocate аллокатора: содержимое
+    // переносится побайтно, а адрес может измениться. Допустимо только для тривиально
+    // перемещаемых элементов. Возвращает false, если аллокатор не умеет переразмещать
+    bool TryReallocate(size_t new_capacity) {
+        if constexpr (detail::AllocatorCanReallocate<Allocator, T>) {
+            static_assert(is_trivially_relocatable_v<T>);
+            buffer_ = buffer_ != nullptr ? alloc_.reallocate(buffer_, capacity_, new_capacity)
+                                         : Allocate(new_capacity);
+            capacity_ = new_capacity;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
 private:
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T *Allocate(size_t n) {
-        return n != 0 ? static_cast<T *>(operator new(n * sizeof(T))) : nullptr;
+    T *Allocate(size_t n) {
+        return n != 0 ? AllocTraits::allocate(alloc_, n) : nullptr;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T *buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    void Deallocate(T *buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+        }
     }
 
+    [[no_unique_address]] Allocator alloc_;
     T *buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
+// Тег конструктора и Resize, инициализирующих элементы по умолчанию вместо value-инициализации
+struct default_init_t {
+    explicit default_init_t() = default;
+};
+
+inline constexpr default_init_t default_init{};
+
+// Политика параллельного построения элементов для больших векторов: Vector(parallel, other),
+// Resize(parallel, n), Assign(parallel, n, value). Каждый поток строит свой непрерывный кусок,
+// так что и первое касание страниц распределяется по потокам (и по их узлам NUMA).
+// Своя политика вместо std::execution::par: <execution> тянет за собой TBB и при сборке с ним
+// требует линковки с libtbb у каждого, кто включает vector.h
+struct parallel_t {
+    // Число потоков; 0 означает std::thread::hardware_concurrency()
+    unsigned threads = 0;
+    // Меньше стольких элементов на поток работа не делится
+    size_t min_chunk = size_t{1} << 16;
+};
+
+inline constexpr parallel_t parallel{};
+
+namespace detail {
+
+// Строит n элементов в неинициализированной памяти dst, деля её на куски между потоками:
+// construct(chunk, offset, count) строит count элементов в chunk = dst + offset. Если какой-либо
+// кусок бросил, уничтожаются все построенные куски и пробрасывается первое исключение.
+// Не удалось запустить поток — его кусок строится в вызывающем
+template <typename T, typename Construct>
+void ParallelConstructN(T *dst, size_t n, const parallel_t &policy, Construct construct) {
+    const size_t threads = policy.threads != 0 ? policy.threads : std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunks = std::min(threads, std::max<size_t>(n / std::max<size_t>(policy.min_chunk, 1), 1));
+    if (chunks <= 1) {
+        construct(dst, size_t{0}, n);
+        return;
+    }
+
+    const size_t step = (n + chunks - 1) / chunks;
+    auto errors = std::make_unique<std::exception_ptr[]>(chunks);
+    auto run = [&](size_t chunk) noexcept {
+        const size_t offset = std::min(n, chunk * step);
+        try {
+            construct(dst + offset, offset, std::min(step, n - offset));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    {
+        auto workers = std::make_unique<std::jthread[]>(chunks - 1);
+        size_t started = 1;
+        try {
+            for (; started < chunks; ++started) {
+                workers[started - 1] = std::jthread(run, started);
+            }
+        } catch (const std::system_error &) {
+            for (size_t chunk = started; chunk < chunks; ++chunk) {
+                run(chunk);
+            }
+        }
+        run(0);
+    }
+
+    auto failed = std::find_if(errors.get(), errors.get() + chunks, [](const auto &error) { return error != nullptr; });
+    if (failed != errors.get() + chunks) {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            if (errors[chunk] == nullptr) {
+                const size_t offset = std::min(n, chunk * step);
+                std::destroy_n(dst + offset, std::min(step, n - offset));
+            }
+        }
+        std::rethrow_exception(*failed);
+    }
+}
+
+}  // namespace detail
+
+// Политики роста вместимости. NextCapacity<T>(capacity, required) возвращает новую вместимость
+// не меньше required, когда текущей capacity не хватает
+
+// Удвоение, начиная с одного элемента
+struct DoublingGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity, size_t required) noexcept {
+        return std::max(capacity == 0 ? 1 : detail::SaturatingAdd(capacity, capacity), required);
+    }
+};
+
+// Рост в полтора раза: меньше перерасход памяти на больших векторах ценой лишних переразмещений
+struct HalfGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity, size_t required) noexcept {
+        return std::max(detail::SaturatingAdd(capacity, std::max<size_t>(capacity / 2, 1)), required);
+    }
+};
+
+// Доводит вместимость, выбранную Base, до границы класса размеров аллокатора, чтобы не
+// оставлять неиспользуемым хвост блока, который аллокатор всё равно выделит
+template <typename Base = DoublingGrowth>
+struct SizeClassGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity, size_t required) noexcept {
+        const size_t base = Base::template NextCapacity<T>(capacity, required);
+        if (base > std::numeric_limits<size_t>::max() / sizeof(T) / 2) {
+            return base;
+        }
+        return detail::RoundUpToSizeClass(base * sizeof(T)) / sizeof(T);
+    }
+};
+
+// Не даёт начинать с крошечных буферов: первая же вместимость занимает не меньше MinBytes
+// (по умолчанию одну кеш-линию)
+template <typename Base = DoublingGrowth, size_t MinBytes = 64>
+struct MinCapacityGrowth {
+    template <typename T>
+    static constexpr size_t NextCapacity(size_t capacity, size_t required) noexcept {
+        constexpr size_t min_capacity = std::max<size_t>((MinBytes + sizeof(T) - 1) / sizeof(T), 1);
+        return std::max(Base::template NextCapacity<T>(capacity, required), min_capacity);
+    }
+};
+
+// Способ, которым элементы переезжают в новый буфер
+enum class RelocationKind {
+    kBitwise,  // memcpy тривиально перемещаемых элементов
+    kMove,
+    kCopy,
+};
+
+namespace detail {
+
 template <typename T>
+inline constexpr RelocationKind relocation_kind_v =
+    is_trivially_relocatable_v<T>                                                     ? RelocationKind::kBitwise
+    : std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T> ? RelocationKind::kMove
+                                                                                    : RelocationKind::kCopy;
+
+}  // namespace detail
+
+// Политика инструментирования Vector: статические обработчики событий. Эта политика ничего не
+// делает, и компилятор выбрасывает её вызовы, так что её можно оставлять в релизных сборках.
+// Счётчики на её месте даёт CountingInstrumentation из vector_stats.h
+struct NoInstrumentation {
+    // От аллокатора получен буфер размером bytes: новый блок, переразмещение или расширение на месте
+    static void OnAllocate(size_t) noexcept {
+    }
+
+    // count элементов перенесены в новый буфер способом kind
+    static void OnRelocate(size_t, RelocationKind) noexcept {
+    }
+
+    // Insert или Erase сдвинули count элементов хвоста
+    static void OnShift(size_t) noexcept {
+    }
+
+    // Размер или вместимость выросли: теперь size при вместимости capacity
+    static void OnSize(size_t, size_t) noexcept {
+    }
+};
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename Instrumentation = NoInstrumentation>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
     using iterator = T *;
     using const_iterator = const T *;
+    using allocator_type = Allocator;
+
+    class BackInserter;
+
+    // Гарантированное выравнивание Data(): с AlignedAllocator<T, 64> компилятор векторизует циклы
+    // по [begin(), end()) без пролога для невыровненного начала
+    static constexpr size_t kAlignment = detail::allocator_alignment_v<Allocator, T>;
 
     iterator begin() noexcept {
-        return data_.GetAddress();
+        return Data();
     }
 
     iterator end() noexcept {
-        return data_.GetAddress() + size_;
+        return Data() + size_;
     }
 
     const_iterator begin() const noexcept {
@@ -108,42 +842,124 @@ public:
     }
 
     const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+        return Data();
     }
 
     const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+        return Data() + size_;
+    }
+
+    T *Data() noexcept {
+        return std::assume_aligned<kAlignment>(data_.GetAddress());
+    }
+
+    const T *Data() const noexcept {
+        return std::assume_aligned<kAlignment>(data_.GetAddress());
     }
 
     Vector() = default;
 
-    explicit Vector(size_t size) : data_(size), size_(size) {
+    explicit Vector(const Allocator &alloc) noexcept : data_(alloc) {
+    }
+
+    explicit Vector(size_t size, const Allocator &alloc = Allocator()) : data_(size, alloc), size_(size) {
+        NoteAllocation();
         std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        NoteSize();
+    }
+
+    // Элементы инициализируются по умолчанию: для тривиальных типов память не заполняется вовсе
+    Vector(size_t size, default_init_t, const Allocator &alloc = Allocator()) : data_(size, alloc), size_(size) {
+        NoteAllocation();
+        std::uninitialized_default_construct_n(data_.GetAddress(), size);
+        NoteSize();
+    }
+
+    Vector(const Vector &other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    Vector(const parallel_t &policy, size_t size, const Allocator &alloc = Allocator())
+        : data_(size, alloc), size_(size) {
+        NoteAllocation();
+        detail::ParallelConstructN(data_.GetAddress(), size, policy,
+                                   [](T *chunk, size_t, size_t count) {
+                                       std::uninitialized_value_construct_n(chunk, count);
+                                   });
+        NoteSize();
     }
 
-    Vector(const Vector &other) : data_(other.size_), size_(other.size_) {
+    Vector(const parallel_t &policy, const Vector &other)
+        : Vector(policy, other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    Vector(const parallel_t &policy, const Vector &other, const Allocator &alloc)
+        : data_(other.size_, alloc), size_(other.size_) {
+        NoteAllocation();
+        const T *source = other.data_.GetAddress();
+        detail::ParallelConstructN(data_.GetAddress(), size_, policy, [source](T *chunk, size_t offset, size_t count) {
+            detail::UninitializedCopyN(source + offset, count, chunk);
+        });
+        NoteSize();
+    }
+
+    Vector(const Vector &other, const Allocator &alloc) : data_(other.size_, alloc), size_(other.size_) {
+        NoteAllocation();
         std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        NoteSize();
+    }
+
+    Vector(Vector &&other) noexcept : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {
     }
 
-    Vector(Vector &&other) noexcept {
-        Swap(other);
+    // Если alloc не равен аллокатору other, буфер забрать нельзя и элементы перемещаются по одному
+    Vector(Vector &&other, const Allocator &alloc)
+        : data_(alloc == other.GetAllocator() ? 0 : other.size_, alloc) {
+        if (alloc == other.GetAllocator()) {
+            data_.Swap(other.data_);
+            std::swap(size_, other.size_);
+        } else {
+            AssignFrom(std::make_move_iterator(other.begin()), other.size_);
+        }
     }
 
     Vector &operator=(const Vector &rhs) {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value
+                          && !AllocTraits::is_always_equal::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Текущий буфер должен быть освобождён старым аллокатором, поэтому копию
+                    // строим сразу на аллокаторе rhs и забираем её вместе с ним
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    StealFrom(rhs_copy);
+                    return *this;
+                }
+            }
             if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
+                Vector rhs_copy(rhs, GetAllocator());
                 Swap(rhs_copy);
             } else {
-                CopyAssignFrom(rhs);
+                AssignFrom(rhs.begin(), rhs.size_);
             }
         }
         return *this;
     }
 
-    Vector &operator=(Vector &&rhs) noexcept {
+    Vector &operator=(Vector &&rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value
+                || GetAllocator() == rhs.GetAllocator()) {
+                StealFrom(rhs);
+            } else {
+                // Аллокатор не распространяется, а буфер rhs освободить мы не сможем
+                if (rhs.size_ > data_.Capacity()) {
+                    Vector rhs_moved(std::move(rhs), GetAllocator());
+                    Swap(rhs_moved);
+                } else {
+                    AssignFrom(std::make_move_iterator(rhs.begin()), rhs.size_);
+                }
+            }
         }
         return *this;
     }
@@ -169,25 +985,80 @@ public:
         return data_.Capacity();
     }
 
+    // Без propagate_on_container_swap обмен допустим только для равных аллокаторов
     void Swap(Vector &other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
 
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
     void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
 
-        RawMemory<T> new_data(new_capacity);
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
-        } else {
-            std::uninitialized_copy_n(data_.GetAddress(), size_, new_data.GetAddress());
+        if (TryGrowInPlace(new_capacity)) {
+            NoteAllocation();
+            return;
         }
 
-        std::destroy_n(data_.GetAddress(), size_);
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        NoteRelocation(size_);
+        detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
+        data_.Swap(new_data);
+        NoteAllocation();
+    }
+
+    // Уменьшает вместимость до размера
+    void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
+
+    // Уменьшает вместимость до max(new_capacity, Size()). Если аллокатор умеет, буфер ужимается
+    // на месте, иначе элементы переносятся в новый буфер нужного размера
+    void ShrinkTo(size_t new_capacity) {
+        new_capacity = std::max(new_capacity, size_);
+        if (new_capacity >= data_.Capacity()) {
+            return;
+        }
+
+        if (new_capacity == 0) {
+            RawMemory<T, Allocator> empty(data_.GetAllocator());
+            data_.Swap(empty);
+            NoteSize();
+            return;
+        }
+
+        if (data_.TryShrink(new_capacity)) {
+            NoteAllocation();
+            return;
+        }
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (data_.TryReallocate(new_capacity)) {
+                NoteAllocation();
+                return;
+            }
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        NoteRelocation(size_);
+        detail::UninitializedRelocateN(data_.GetAddress(), size_, new_data.GetAddress());
         data_.Swap(new_data);
+        NoteAllocation();
+    }
+
+    // Уничтожает все элементы. С release_memory буфер тоже возвращается аллокатору
+    void Clear(bool release_memory = false) noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        if (release_memory) {
+            RawMemory<T, Allocator> empty(data_.GetAllocator());
+            data_.Swap(empty);
+        }
+        NoteSize();
     }
 
     void Resize(size_t new_size) {
@@ -199,7 +1070,112 @@ public:
 
             std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
             size_ = new_size;
+            NoteSize();
+        }
+    }
+
+    // То же, что Resize, но новые элементы инициализируются по умолчанию, а не обнуляются.
+    // Подходит для буферов, которые сразу же перезапишет read() или декодер
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+        } else if (new_size > size_) {
+            Reserve(new_size);
+
+            std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
+            NoteSize();
+        }
+    }
+
+    // Новые элементы строятся параллельно. Если построение бросит, размер не меняется
+    void Resize(const parallel_t &policy, size_t new_size) {
+        if (new_size <= size_) {
+            Resize(new_size);
+            return;
+        }
+        Reserve(new_size);
+        detail::ParallelConstructN(data_.GetAddress() + size_, new_size - size_, policy,
+                                   [](T *chunk, size_t, size_t count) {
+                                       std::uninitialized_value_construct_n(chunk, count);
+                                   });
+        size_ = new_size;
+        NoteSize();
+    }
+
+    // Заменяет содержимое на count копий value, построенных параллельно; аллокатор сохраняется.
+    // Старые элементы уничтожаются заранее, поэтому при исключении вектор остаётся пустым
+    void Assign(const parallel_t &policy, size_t count, const T &value) {
+        if (count > data_.Capacity()) {
+            // value может лежать в этом же векторе
+            Vector replacement(GetAllocator());
+            replacement.Reserve(count);
+            detail::ParallelConstructN(replacement.data_.GetAddress(), count, policy,
+                                       [&value](T *chunk, size_t, size_t n) {
+                                           std::uninitialized_fill_n(chunk, n, value);
+                                       });
+            replacement.size_ = count;
+            replacement.NoteSize();
+            Swap(replacement);
+            return;
+        }
+        const T copy(value);
+        Clear();
+        detail::ParallelConstructN(data_.GetAddress(), count, policy,
+                                   [&copy](T *chunk, size_t, size_t n) { std::uninitialized_fill_n(chunk, n, copy); });
+        size_ = count;
+        NoteSize();
+    }
+
+    // Заменяет содержимое копией other, построенной параллельно; аллокатор сохраняется
+    void Assign(const parallel_t &policy, const Vector &other) {
+        if (this != &other) {
+            Vector copy(policy, other, GetAllocator());
+            Swap(copy);
+        }
+    }
+
+    // По образцу std::string::resize_and_overwrite отдаёт буфер под new_size элементов в op(data, new_size).
+    // На входе живы первые min(Size(), new_size) элементов, остальное — сырая память. op возвращает
+    // новый размер r <= new_size и обязан оставить живыми ровно первые r элементов: недостающие он
+    // создаёт сам, а лишние уничтожает или переносит. Для тривиальных типов достаточно записать байты.
+    // Бросая исключение, op должен оставить буфер в том виде, в каком его получил
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t new_size, Operation op) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+        } else {
+            Reserve(new_size);
+        }
+
+        const size_t result = std::move(op)(data_.GetAddress(), new_size);
+        assert(result <= new_size);
+        size_ = result;
+        NoteSize();
+    }
+
+    // Отдаёт сырую память под count элементов за концом вектора, чтобы read, recv или завершение
+    // io_uring писали прямо в буфер. Вместимость наращивается по GrowthPolicy, поэтому повторные
+    // вызовы амортизированы. Элементами записанные байты становятся только после CommitTail.
+    // Память действительна до следующего изменения вместимости
+    std::span<T> ReserveTail(size_t count)
+        requires std::is_trivially_copyable_v<T>
+    {
+        if (count > data_.Capacity() - size_) {
+            Reserve(GrowthPolicy::template NextCapacity<T>(data_.Capacity(), detail::SaturatingAdd(size_, count)));
         }
+        return {data_.GetAddress() + size_, count};
+    }
+
+    // Добавляет к вектору первые count элементов, записанных в память за его концом
+    void CommitTail(size_t count) noexcept
+        requires std::is_trivially_copyable_v<T>
+    {
+        assert(count <= data_.Capacity() - size_);
+        size_ += count;
+        NoteSize();
     }
 
     void PushBack(const T &value) {
@@ -212,7 +1188,22 @@ public:
 
     template <typename... Args>
     T &EmplaceBack(Args &&...args) {
-        return *Emplace(end(), std::forward<Args>(args)...);
+        if (size_ == data_.Capacity()) [[unlikely]] {
+            return *Emplace(end(), std::forward<Args>(args)...);
+        }
+        return UncheckedEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // EmplaceBack без проверки вместимости: место должно быть заранее зарезервировано, в отладочной
+    // сборке это проверяет assert. Буфер не переразмещается, поэтому args могут ссылаться на
+    // элементы самого вектора
+    template <typename... Args>
+    T &UncheckedEmplaceBack(Args &&...args) {
+        assert(size_ < data_.Capacity());
+        T *slot = std::construct_at(data_.GetAddress() + size_, std::forward<Args>(args)...);
+        ++size_;
+        NoteSize();
+        return *slot;
     }
 
     void PopBack() noexcept {
@@ -229,75 +1220,330 @@ public:
         return Emplace(pos, std::move(value));
     }
 
+    // Вставляет элементы [first, last) перед pos. Вместимость наращивается не более одного раза,
+    // хвост сдвигается тоже один раз. Диапазон не должен указывать внутрь самого вектора
+    template <std::input_iterator InputIt>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            return InsertRange(pos, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // Однопроходный диапазон нельзя измерить заранее, поэтому сначала он собирается отдельно
+            Vector values(GetAllocator());
+            for (; first != last; ++first) {
+                values.EmplaceBack(*first);
+            }
+            return InsertRange(pos, std::make_move_iterator(values.begin()), values.Size());
+        }
+    }
+
+    iterator Insert(const_iterator pos, size_t count, const T &value) {
+        // value может оказаться элементом этого же вектора, который сдвинется при вставке
+        const T value_copy(value);
+        return InsertRange(pos, detail::RepeatIterator<T>(value_copy), count);
+    }
+
+    iterator Insert(const_iterator pos, std::initializer_list<T> values) {
+        return InsertRange(pos, values.begin(), values.size());
+    }
+
+    // Дописывает копии values в конец. В отличие от Insert, values может ссылаться на сам вектор
+    void Append(std::span<const T> values) {
+        InsertRange(cend(), values.begin(), values.size());
+    }
+
+    void AppendN(size_t count, const T &value) {
+        Insert(cend(), count, value);
+    }
+
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args &&...args) {
-        assert(pos >= cbegin() && pos <= cend());
+        return EmplaceAt<true>(pos, std::forward<Args>(args)...);
+    }
+
+    // Как Emplace, но args не должны ссылаться на элементы вектора. Тогда тривиально перемещаемый
+    // хвост сдвигается одним memmove, а элемент строится сразу на своём месте без временной копии,
+    // если это не бросает исключений
+    template <typename... Args>
+    iterator EmplaceNoAlias(const_iterator pos, Args &&...args) {
+        return EmplaceAt<false>(pos, std::forward<Args>(args)...);
+    }
+
+    iterator Erase(const_iterator pos) noexcept(is_trivially_relocatable_v<T> || std::is_nothrow_move_assignable_v<T>) {
+        assert(pos >= cbegin() && pos < cend());
         size_t index = pos - cbegin();
 
-        if (size_ < data_.Capacity()) {
-            if (pos == cend()) {
-                std::construct_at(end(), std::forward<Args>(args)...);
-                size_++;
-                return end() - 1;
-            }
+        NoteShift(size_ - index - 1);
+        detail::EraseAt(data_.GetAddress(), size_, index);
+        --size_;
+        return begin() + index;
+    }
 
-            T tmp_copy(std::forward<Args>(args)...);
+    iterator Erase(const_iterator first, const_iterator last) noexcept(is_trivially_relocatable_v<T>
+                                                                       || std::is_nothrow_move_assignable_v<T>) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        size_t index = first - cbegin();
+        size_t count = last - first;
 
-            std::construct_at(end(), std::move(*(end() - 1)));
-            std::move_backward(begin() + index, end() - 1, end());
+        if (count != 0) {
+            NoteShift(size_ - index - count);
+            detail::EraseRange(data_.GetAddress(), size_, index, count);
+            size_ -= count;
+        }
+        return begin() + index;
+    }
 
-            data_[index] = std::move(tmp_copy);
+    // Удаляет все элементы, для которых pred вернул true, за один проход уплотнения
+    // и возвращает количество удалённых
+    template <typename Predicate>
+    friend size_t EraseIf(Vector &vector, Predicate pred) {
+        const size_t old_size = vector.size_;
+        detail::CompactIf(vector.data_.GetAddress(), vector.size_, pred);
+        return old_size - vector.size_;
+    }
 
-            ++size_;
-            return begin() + index;
+private:
+    RawMemory<T, Allocator> data_;
+    size_t size_ = 0;
+
+    // Наращивает вместимость, не выделяя новый буфер: расширением на месте, а для
+    // тривиально перемещаемых T ещё и через reallocate аллокатора
+    bool TryGrowInPlace(size_t new_capacity) {
+        if (data_.TryExpand(new_capacity)) {
+            return true;
+        }
+        if constexpr (is_trivially_relocatable_v<T>) {
+            return data_.TryReallocate(new_capacity);
         } else {
-            RawMemory<T> new_data(data_.Capacity() == 0 ? 1 : data_.Capacity() * 2);
+            return false;
+        }
+    }
+
+    template <bool kMayAlias, typename... Args>
+    iterator EmplaceAt(const_iterator pos, Args &&...args) {
+        assert(pos >= cbegin() && pos <= cend());
+        size_t index = pos - cbegin();
 
-            std::construct_at(new_data.GetAddress() + index, std::forward<Args>(args)...);
+        if (size_ == data_.Capacity()) {
+            const size_t new_capacity = GrowthPolicy::template NextCapacity<T>(data_.Capacity(), size_ + 1);
+            // Расширение на месте не двигает буфер, поэтому ссылки в args остаются валидными
+            if (!data_.TryExpand(new_capacity)) {
+                return EmplaceWithReallocation(index, new_capacity, std::forward<Args>(args)...);
+            }
+            NoteAllocation();
+        }
 
-            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-                std::uninitialized_move_n(begin(), index, new_data.GetAddress());
-                std::uninitialized_move_n(begin() + index, size_ - index, new_data.GetAddress() + index + 1);
-            } else {
-                std::uninitialized_copy_n(begin(), index, new_data.GetAddress());
-                std::uninitialized_copy_n(begin() + index, size_ - index, new_data.GetAddress() + index + 1);
+        NoteShift(size_ - index);
+        if constexpr (kMayAlias) {
+            detail::EmplaceInPlace(data_.GetAddress(), size_, index, std::forward<Args>(args)...);
+        } else {
+            detail::EmplaceInPlaceNoAlias(data_.GetAddress(), size_, index, std::forward<Args>(args)...);
+        }
+        ++size_;
+        NoteSize();
+        return begin() + index;
+    }
+
+    template <typename... Args>
+    iterator EmplaceWithReallocation(size_t index, size_t new_capacity, Args &&...args) {
+        if constexpr (is_trivially_relocatable_v<T> && detail::AllocatorCanReallocate<Allocator, T>) {
+            // reallocate может сдвинуть буфер, а args — ссылаться на его элементы, поэтому
+            // значение создаётся заранее и затем переносится на своё место побайтно
+            alignas(T) std::byte slot[sizeof(T)];
+            T *value = std::construct_at(reinterpret_cast<T *>(slot), std::forward<Args>(args)...);
+            try {
+                data_.TryReallocate(new_capacity);
+            } catch (...) {
+                std::destroy_at(value);
+                throw;
             }
+            NoteAllocation();
+            NoteShift(size_ - index);
+            detail::RelocateOverlappingN(begin() + index, size_ - index, begin() + index + 1);
+            detail::UninitializedRelocateN(value, 1, begin() + index);
 
-            std::destroy_n(begin(), size_);
+            ++size_;
+            NoteSize();
+            return begin() + index;
+        } else {
+            RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+            detail::EmplaceRelocating(data_.GetAddress(), size_, index, new_data.GetAddress(),
+                                      std::forward<Args>(args)...);
+            NoteRelocation(size_);
             data_.Swap(new_data);
+            NoteAllocation();
 
             ++size_;
+            NoteSize();
             return begin() + index;
         }
     }
 
-    iterator Erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
-        assert(pos >= cbegin() && pos < cend());
+    template <typename ForwardIt>
+    iterator InsertRange(const_iterator pos, ForwardIt first, size_t count) {
+        assert(pos >= cbegin() && pos <= cend());
         size_t index = pos - cbegin();
 
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::move(begin() + index + 1, end(), begin() + index);
-        } else {
-            std::copy(begin() + index + 1, end(), begin() + index);
+        if (count == 0) {
+            return begin() + index;
         }
 
-        std::destroy_at(end() - 1);
+        if (size_ + count > data_.Capacity()) {
+            const size_t new_capacity = GrowthPolicy::template NextCapacity<T>(data_.Capacity(), size_ + count);
+            if (!data_.TryExpand(new_capacity) && !(MayReallocateUnder(first) && TryGrowInPlace(new_capacity))) {
+                RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+                detail::UninitializedCopyN(first, count, new_data.GetAddress() + index);
+                try {
+                    detail::RelocateAroundGap(data_.GetAddress(), size_, index, new_data.GetAddress(), count);
+                } catch (...) {
+                    std::destroy_n(new_data.GetAddress() + index, count);
+                    throw;
+                }
+                NoteRelocation(size_);
+                data_.Swap(new_data);
+                NoteAllocation();
+                size_ += count;
+                NoteSize();
+                return begin() + index;
+            }
+            NoteAllocation();
+        }
 
-        --size_;
+        NoteShift(size_ - index);
+        detail::InsertRangeInPlace(data_.GetAddress(), size_, index, first, count);
+        size_ += count;
+        NoteSize();
         return begin() + index;
     }
 
-private:
-    RawMemory<T> data_;
-    size_t size_ = 0;
+    // Можно ли переразместить буфер, пока вставляемые элементы читаются из first: нельзя,
+    // если first указывает внутрь самого буфера
+    template <typename ForwardIt>
+    bool MayReallocateUnder(ForwardIt first) const noexcept {
+        if constexpr (std::contiguous_iterator<ForwardIt>) {
+            const void *source = std::to_address(first);
+            return std::less<const void *>()(source, data_.GetAddress())
+                   || !std::less<const void *>()(source, data_.GetAddress() + data_.Capacity());
+        } else {
+            return true;
+        }
+    }
+
+    // Сообщают политике инструментирования о событиях; с NoInstrumentation вызовы исчезают целиком
+
+    // Буфер текущей вместимости только что получен от аллокатора, в том числе ужат или
+    // переразмещён им на месте
+    void NoteAllocation() noexcept {
+        if (data_.Capacity() != 0) {
+            Instrumentation::OnAllocate(data_.Capacity() * sizeof(T));
+            NoteSize();
+        }
+    }
+
+    void NoteRelocation(size_t count) noexcept {
+        Instrumentation::OnRelocate(count, detail::relocation_kind_v<T>);
+    }
+
+    void NoteShift(size_t count) noexcept {
+        Instrumentation::OnShift(count);
+    }
+
+    void NoteSize() noexcept {
+        Instrumentation::OnSize(size_, data_.Capacity());
+    }
+
+    // Уничтожает свои элементы и забирает буфер other вместе с его аллокатором
+    void StealFrom(Vector &other) noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        data_ = std::move(other.data_);
+        size_ = std::exchange(other.size_, 0);
+    }
 
-    void CopyAssignFrom(const Vector &rhs) {
-        std::copy_n(rhs.data_.GetAddress(), std::min(size_, rhs.size_), data_.GetAddress());
-        if (rhs.size_ < size_) {
-            std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
+    // Присваивает count элементов, начиная с first, поверх уже созданных элементов.
+    // Вместимости должно хватать; с std::move_iterator элементы перемещаются
+    template <typename InputIt>
+    void AssignFrom(InputIt first, size_t count) {
+        assert(count <= data_.Capacity());
+        std::copy_n(first, std::min(size_, count), data_.GetAddress());
+        if (count < size_) {
+            std::destroy_n(data_.GetAddress() + count, size_ - count);
         } else {
-            std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
+            std::uninitialized_copy_n(first + size_, count - size_, data_.GetAddress() + size_);
         }
-        size_ = rhs.size_;
+        size_ = count;
+    }
+};
+
+// Дописывает элементы в зарезервированный хвост вектора, держа позицию записи у себя, а не в
+// vector: размер обновляется один раз в Commit или в деструкторе, и цикл заполнения не перечитывает
+// поля вектора после каждой записи. Пока BackInserter жив, с вектором можно работать только через
+// него. Элементы за пределами размера не уничтожаются, поэтому T должен быть тривиально разрушаемым
+//
+//   v.Reserve(v.Size() + n);
+//   Vector<int>::BackInserter out(v);
+//   for (size_t i = 0; i < n; ++i) {
+//       out.PushBack(Decode(input, i));
+//   }
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+class Vector<T, Allocator, GrowthPolicy, Instrumentation>::BackInserter {
+    static_assert(std::is_trivially_destructible_v<T>);
+
+public:
+    explicit BackInserter(Vector &vector) noexcept
+        : vector_(&vector),
+          committed_(vector.data_.GetAddress() + vector.size_),
+          pos_(committed_),
+          last_(vector.data_.GetAddress() + vector.data_.Capacity()) {
+    }
+
+    BackInserter(const BackInserter &) = delete;
+    BackInserter &operator=(const BackInserter &) = delete;
+
+    ~BackInserter() {
+        Commit();
+    }
+
+    // Сколько элементов ещё поместится без переразмещения
+    size_t Available() const noexcept {
+        return last_ - pos_;
+    }
+
+    void PushBack(const T &value) {
+        EmplaceBack(value);
     }
+
+    // Место должно быть: проверяется только assert
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args) {
+        assert(pos_ != last_);
+        T *slot = std::construct_at(pos_, std::forward<Args>(args)...);
+        ++pos_;
+        return *slot;
+    }
+
+    // Переносит записанные элементы в размер вектора
+    void Commit() noexcept {
+        vector_->size_ += pos_ - committed_;
+        committed_ = pos_;
+        vector_->NoteSize();
+    }
+
+private:
+    Vector *vector_;
+    T *committed_;
+    T *pos_;
+    T *last_;
 };
+
+// Vector с буфером, выровненным по Alignment байт (по умолчанию по строке кэша)
+template <typename T, size_t Alignment = kCacheLineSize, typename GrowthPolicy = DoublingGrowth,
+          typename Instrumentation = NoInstrumentation>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, GrowthPolicy, Instrumentation>;
+
+namespace pmr {
+
+// Vector, память которого берётся из std::pmr::memory_resource, например из
+// std::pmr::monotonic_buffer_resource, освобождаемого целиком одним вызовом
+template <typename T, typename GrowthPolicy = DoublingGrowth, typename Instrumentation = NoInstrumentation>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy, Instrumentation>;
+
+}  // namespace pmr
@@ -0,0 +1,153 @@
+#pragma once
+#include "vector.h"
+
+#include <coroutine>
+#include <exception>
+
+// Потоковое наполнение Vector из асинхронного источника: данные читаются прямо в хвост буфера через
+// ReserveTail/CommitTail, без промежуточного буфера и поэлементного копирования после чтения.
+//
+// Источник — любой объект с source.ReadSome(std::span<T> buffer), возвращающим awaitable, который
+// завершается числом записанных элементов (0 — источник исчерпан):
+//
+//   IngestTask Receive(Vector<std::byte> &packet, Socket &socket) {
+//       const size_t received = co_await AppendFrom(packet, socket);
+//       ...
+//   }
+
+// Ленивая корутина, возвращающая количество добавленных элементов. Запускается при co_await и
+// по завершении передаёт управление ожидающей корутине без роста стека
+class [[nodiscard]] IngestTask {
+public:
+    struct promise_type {
+        size_t result = 0;
+        std::exception_ptr exception;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        IngestTask get_return_object() noexcept {
+            return IngestTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    return handle.promise().continuation;
+                }
+
+                void await_resume() noexcept {
+                }
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_value(size_t value) noexcept {
+            result = value;
+        }
+
+        void unhandled_exception() noexcept {
+            exception = std::current_exception();
+        }
+    };
+
+    IngestTask(IngestTask &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    IngestTask &operator=(IngestTask &&rhs) noexcept {
+        if (this != &rhs) {
+            Destroy();
+            handle_ = std::exchange(rhs.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~IngestTask() {
+        Destroy();
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    // Исключение источника или аллокатора перебрасывается ожидающему
+    size_t await_resume() const {
+        if (handle_.promise().exception) {
+            std::rethrow_exception(handle_.promise().exception);
+        }
+        return handle_.promise().result;
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit IngestTask(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {
+    }
+
+    void Destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+};
+
+// Элементов в одном чтении по умолчанию: 64 КиБ
+template <typename T>
+inline constexpr size_t kDefaultIngestChunk = std::max<size_t>(64 * 1024 / sizeof(T), 1);
+
+// Дописывает в target всё, что отдаёт source, читая до chunk элементов за раз прямо в хвост
+// target. Возвращает количество добавленных элементов. target и source должны жить, пока корутина
+// не завершится, и не меняться никем другим.
+//
+// Рост буфера не задерживает чтение: когда хвоста не хватает, сразу выделяется следующий буфер,
+// чтение запускается в его хвост, и, пока оно идёт, старые элементы копируются в его начало.
+// Перекрытие получается с источниками, которые начинают операцию в ReadSome, а не при co_await,
+// как большинство обёрток над io_uring и asio; с ленивыми источниками копирование идёт до чтения.
+// Если чтение бросит, target остаётся таким, каким был после последнего завершённого чтения
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation, typename Source>
+    requires std::is_trivially_copyable_v<T>
+IngestTask AppendFrom(Vector<T, Allocator, GrowthPolicy, Instrumentation> &target, Source &source,
+                      size_t chunk = kDefaultIngestChunk<T>) {
+    using Container = Vector<T, Allocator, GrowthPolicy, Instrumentation>;
+    assert(chunk > 0);
+
+    size_t total = 0;
+    while (true) {
+        size_t read = 0;
+        if (chunk <= target.Capacity() - target.Size()) {
+            read = co_await source.ReadSome(target.ReserveTail(chunk));
+            assert(read <= chunk);
+            target.CommitTail(read);
+        } else {
+            const size_t old_size = target.Size();
+            Container next(target.GetAllocator());
+            next.Reserve(GrowthPolicy::template NextCapacity<T>(target.Capacity(),
+                                                                detail::SaturatingAdd(old_size, chunk)));
+            const std::span<T> buffer = next.ReserveTail(old_size + chunk);
+            auto reading = source.ReadSome(buffer.subspan(old_size, chunk));
+            if (old_size != 0) {
+                std::memcpy(buffer.data(), target.Data(), old_size * sizeof(T));
+            }
+            next.CommitTail(old_size);
+            read = co_await std::move(reading);
+            assert(read <= chunk);
+            next.CommitTail(read);
+            target.Swap(next);
+        }
+        if (read == 0) {
+            co_return total;
+        }
+        total += read;
+    }
+}
@@ -0,0 +1,387 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+
+// Векторизованные проходы по непрерывному буферу Vector для арифметических T: Find, Contains, Count,
+// MinMax, Sum, InclusiveScan и FilterInto. Ядра написаны один раз на векторных расширениях GCC и
+// собираются под ширину регистра 16, 32 и 64 байта; при первом вызове по cpuid выбирается самая
+// широкая поддерживаемая (AVX-512, AVX2, иначе базовая: SSE2 на x86-64, NEON на AArch64). Типы
+// размером не 4 и не 8 байт обходятся скалярным циклом.
+//
+// Если Vector выровнен не меньше ширины регистра (AlignedVector), загрузки выровненные.
+// Отличия от std-алгоритмов:
+//  - Sum и InclusiveScan для целых считают по модулю 2^N, как беззнаковые;
+//  - для float и double они складывают в другом порядке, и результат может отличаться в младших битах;
+//  - MinMax на данных с NaN возвращает неопределённую пару
+
+enum class SimdLevel {
+    kBaseline,
+    kAvx2,
+    kAvx512,
+};
+
+namespace detail {
+
+inline SimdLevel DetectSimdLevel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")
+        && __builtin_cpu_supports("avx512vl")) {
+        return SimdLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::kAvx2;
+    }
+#endif
+    return SimdLevel::kBaseline;
+}
+
+}  // namespace detail
+
+// Набор инструкций, под который выбраны ядра. Определяется один раз
+inline SimdLevel ActiveSimdLevel() noexcept {
+    static const SimdLevel level = detail::DetectSimdLevel();
+    return level;
+}
+
+namespace detail {
+
+template <typename T>
+concept SimdArithmetic = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+// Векторный тип из kBytes / sizeof(T) элементов T. Псевдоним шаблона тут не годится: GCC не
+// применяет vector_size к зависимому типу
+template <typename T, size_t kBytes>
+struct SimdVec {
+    typedef T type __attribute__((vector_size(kBytes)));
+};
+
+// Целые складываются как беззнаковые, чтобы переполнение не было UB
+template <typename T>
+using SimdAccumulator = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>,
+                                                    std::type_identity<T>>::type;
+
+// Ядра ниже получают ширину регистра параметром и встраиваются в точки входа с нужным target,
+// поэтому векторы не передаются через границы функций: их ABI зависит от набора инструкций
+template <size_t kBytes, bool kAligned, typename V, typename T>
+[[gnu::always_inline]] inline void SimdLoad(V &v, const T *p) noexcept {
+    if constexpr (kAligned) {
+        std::memcpy(&v, std::assume_aligned<kBytes>(p), sizeof(V));
+    } else {
+        std::memcpy(&v, p, sizeof(V));
+    }
+}
+
+template <size_t kBytes, bool kAligned, typename T>
+[[gnu::always_inline]] inline size_t FindKernel(const T *data, size_t n, T value) noexcept {
+    using V = typename SimdVec<T, kBytes>::type;
+    constexpr size_t kLanes = kBytes / sizeof(T);
+
+    const V needle = V{} + value;
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        V v;
+        SimdLoad<kBytes, kAligned>(v, data + i);
+        const auto eq = v == needle;
+        bool any = false;
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            any |= eq[lane] != 0;
+        }
+        if (any) {
+            break;
+        }
+    }
+    // Добираем хвост или ищем точную позицию в найденном блоке
+    for (; i < n; ++i) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+    return n;
+}
+
+template <size_t kBytes, bool kAligned, typename T>
+[[gnu::always_inline]] inline size_t CountKernel(const T *data, size_t n, T value) noexcept {
+    using V = typename SimdVec<T, kBytes>::type;
+    using Mask = decltype(V{} == V{});
+    constexpr size_t kLanes = kBytes / sizeof(T);
+    // Счётчик в полосе — знаковое целое ширины T; сбрасываем его в total раньше, чем он переполнится
+    constexpr size_t kBlock = size_t{1} << 30;
+
+    const V needle = V{} + value;
+    size_t total = 0;
+    size_t i = 0;
+    while (i + kLanes <= n) {
+        const size_t block_end = i + std::min(n - i, kBlock * kLanes) / kLanes * kLanes;
+        Mask counts{};
+        for (; i < block_end; i += kLanes) {
+            V v;
+            SimdLoad<kBytes, kAligned>(v, data + i);
+            // Совпавшие полосы равны -1
+            counts -= v == needle;
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            total += static_cast<size_t>(counts[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        total += data[i] == value;
+    }
+    return total;
+}
+
+template <size_t kBytes, bool kAligned, typename T>
+[[gnu::always_inline]] inline std::pair<T, T> MinMaxKernel(const T *data, size_t n) noexcept {
+    using V = typename SimdVec<T, kBytes>::type;
+    constexpr size_t kLanes = kBytes / sizeof(T);
+
+    T lo = data[0];
+    T hi = data[0];
+    size_t i = 0;
+    if (n >= kLanes) {
+        V vlo;
+        SimdLoad<kBytes, kAligned>(vlo, data);
+        V vhi = vlo;
+        for (i = kLanes; i + kLanes <= n; i += kLanes) {
+            V v;
+            SimdLoad<kBytes, kAligned>(v, data + i);
+            vlo = v < vlo ? v : vlo;
+            vhi = v > vhi ? v : vhi;
+        }
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            lo = std::min<T>(lo, vlo[lane]);
+            hi = std::max<T>(hi, vhi[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+    return {lo, hi};
+}
+
+template <size_t kBytes, bool kAligned, typename T>
+[[gnu::always_inline]] inline T SumKernel(const T *data, size_t n) noexcept {
+    using A = SimdAccumulator<T>;
+    using V = typename SimdVec<A, kBytes>::type;
+    constexpr size_t kLanes = kBytes / sizeof(T);
+
+    // Два независимых аккумулятора, чтобы сложения не ждали друг друга
+    V acc0{};
+    V acc1{};
+    size_t i = 0;
+    for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+        V v0;
+        V v1;
+        SimdLoad<kBytes, kAligned>(v0, reinterpret_cast<const A *>(data + i));
+        SimdLoad<kBytes, kAligned>(v1, reinterpret_cast<const A *>(data + i + kLanes));
+        acc0 += v0;
+        acc1 += v1;
+    }
+    acc0 += acc1;
+    A sum{};
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+        sum += acc0[lane];
+    }
+    for (; i < n; ++i) {
+        sum += static_cast<A>(data[i]);
+    }
+    return static_cast<T>(sum);
+}
+
+// Префиксные суммы внутри регистра за log2(kLanes) сдвигов со сложением, между регистрами — перенос
+// последней суммы. in и out могут совпадать
+template <size_t kBytes, bool kAligned, typename T>
+[[gnu::always_inline]] inline void InclusiveScanKernel(const T *in, size_t n, T *out) noexcept {
+    using A = SimdAccumulator<T>;
+    using V = typename SimdVec<A, kBytes>::type;
+    constexpr size_t kLanes = kBytes / sizeof(T);
+
+    A carry{};
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        V x;
+        SimdLoad<kBytes, kAligned>(x, reinterpret_cast<const A *>(in + i));
+        const V zero{};
+        // x += x, сдвинутый на Shift полос к старшим, с нулями на освободившихся местах
+        auto shift_add = [&]<size_t Shift>() __attribute__((always_inline)) {
+            [&]<size_t... Lane>(std::index_sequence<Lane...>) __attribute__((always_inline)) {
+                x += __builtin_shufflevector(x, zero, (Lane >= Shift ? Lane - Shift : kLanes + Lane)...);
+            }(std::make_index_sequence<kLanes>{});
+        };
+        [&]<size_t... Step>(std::index_sequence<Step...>) __attribute__((always_inline)) {
+            (shift_add.template operator()<size_t{1} << Step>(), ...);
+        }(std::make_index_sequence<std::countr_zero(kLanes)>{});
+        x += carry;
+        carry = x[kLanes - 1];
+        std::memcpy(out + i, &x, sizeof(V));
+    }
+    for (; i < n; ++i) {
+        carry += static_cast<A>(in[i]);
+        out[i] = static_cast<T>(carry);
+    }
+}
+
+// Пишет каждый элемент в очередную позицию dst и сдвигает позицию на pred(x): без ветвлений,
+// которые на случайных данных предсказывались бы плохо. Возвращает количество оставленных
+template <typename T, typename Predicate>
+[[gnu::always_inline]] inline size_t FilterKernel(const T *in, size_t n, T *dst, Predicate &pred) {
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const T value = in[i];
+        dst[kept] = value;
+        kept += static_cast<bool>(pred(value));
+    }
+    return kept;
+}
+
+// Точки входа: kernel(width, aligned) встраивается в каждую и компилируется под её набор инструкций.
+// aligned истинно, если буфер выровнен не меньше ширины регистра
+template <size_t kAlignment, typename Kernel>
+inline decltype(auto) RunBaseline(Kernel &kernel) {
+    return kernel(std::integral_constant<size_t, 16>{}, std::bool_constant<kAlignment >= 16>{});
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template <size_t kAlignment, typename Kernel>
+[[gnu::target("avx2,bmi2")]] inline decltype(auto) RunAvx2(Kernel &kernel) {
+    return kernel(std::integral_constant<size_t, 32>{}, std::bool_constant<kAlignment >= 32>{});
+}
+
+template <size_t kAlignment, typename Kernel>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl,bmi2")]] inline decltype(auto) RunAvx512(Kernel &kernel) {
+    return kernel(std::integral_constant<size_t, 64>{}, std::bool_constant<kAlignment >= 64>{});
+}
+#endif
+
+// kernel должен быть помечен always_inline, иначе он скомпилируется один раз под базовый набор
+template <size_t kAlignment, typename Kernel>
+decltype(auto) Dispatch(Kernel kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+    switch (ActiveSimdLevel()) {
+        case SimdLevel::kAvx512:
+            return RunAvx512<kAlignment>(kernel);
+        case SimdLevel::kAvx2:
+            return RunAvx2<kAlignment>(kernel);
+        case SimdLevel::kBaseline:
+            break;
+    }
+#endif
+    return RunBaseline<kAlignment>(kernel);
+}
+
+}  // namespace detail
+
+// Первый элемент, равный value, или end()
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+const T *Find(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector, T value) {
+    if constexpr (detail::SimdArithmetic<T>) {
+        constexpr size_t kAlignment = Vector<T, Allocator, GrowthPolicy, Instrumentation>::kAlignment;
+        const T *data = vector.Data();
+        const size_t size = vector.Size();
+        return data + detail::Dispatch<kAlignment>([&](auto width, auto aligned) __attribute__((always_inline)) {
+                   return detail::FindKernel<decltype(width)::value, decltype(aligned)::value>(data, size, value);
+               });
+    } else {
+        return std::find(vector.begin(), vector.end(), value);
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+bool Contains(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector, T value) {
+    return Find(vector, value) != vector.end();
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+size_t Count(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector, T value) {
+    if constexpr (detail::SimdArithmetic<T>) {
+        constexpr size_t kAlignment = Vector<T, Allocator, GrowthPolicy, Instrumentation>::kAlignment;
+        const T *data = vector.Data();
+        const size_t size = vector.Size();
+        return detail::Dispatch<kAlignment>([&](auto width, auto aligned) __attribute__((always_inline)) {
+            return detail::CountKernel<decltype(width)::value, decltype(aligned)::value>(data, size, value);
+        });
+    } else {
+        return std::count(vector.begin(), vector.end(), value);
+    }
+}
+
+// Наименьший и наибольший элементы. Вектор не должен быть пустым
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+std::pair<T, T> MinMax(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector) {
+    assert(vector.Size() > 0);
+    if constexpr (detail::SimdArithmetic<T>) {
+        constexpr size_t kAlignment = Vector<T, Allocator, GrowthPolicy, Instrumentation>::kAlignment;
+        const T *data = vector.Data();
+        const size_t size = vector.Size();
+        return detail::Dispatch<kAlignment>([&](auto width, auto aligned) __attribute__((always_inline)) {
+            return detail::MinMaxKernel<decltype(width)::value, decltype(aligned)::value>(data, size);
+        });
+    } else {
+        const auto [lo, hi] = std::minmax_element(vector.begin(), vector.end());
+        return {*lo, *hi};
+    }
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+T Sum(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector) {
+    if constexpr (detail::SimdArithmetic<T>) {
+        constexpr size_t kAlignment = Vector<T, Allocator, GrowthPolicy, Instrumentation>::kAlignment;
+        const T *data = vector.Data();
+        const size_t size = vector.Size();
+        return detail::Dispatch<kAlignment>([&](auto width, auto aligned) __attribute__((always_inline)) {
+            return detail::SumKernel<decltype(width)::value, decltype(aligned)::value>(data, size);
+        });
+    } else {
+        detail::SimdAccumulator<T> sum{};
+        for (const T value : vector) {
+            sum += static_cast<detail::SimdAccumulator<T>>(value);
+        }
+        return static_cast<T>(sum);
+    }
+}
+
+// Заменяет каждый элемент суммой его и всех предыдущих
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+    requires std::is_arithmetic_v<T>
+void InclusiveScan(Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector) {
+    if constexpr (detail::SimdArithmetic<T>) {
+        constexpr size_t kAlignment = Vector<T, Allocator, GrowthPolicy, Instrumentation>::kAlignment;
+        T *data = vector.Data();
+        const size_t size = vector.Size();
+        detail::Dispatch<kAlignment>([&](auto width, auto aligned) __attribute__((always_inline)) {
+            detail::InclusiveScanKernel<decltype(width)::value, decltype(aligned)::value>(data, size, data);
+        });
+    } else {
+        detail::SimdAccumulator<T> carry{};
+        for (T &value : vector) {
+            carry += static_cast<detail::SimdAccumulator<T>>(value);
+            value = static_cast<T>(carry);
+        }
+    }
+}
+
+// Дописывает в конец out элементы in, для которых pred истинен, сохраняя порядок. Цикл не ветвится
+// по результату pred, поэтому скорость не зависит от того, насколько он предсказуем. Место в out
+// резервируется сразу под все элементы in, а растёт out по своей GrowthPolicy, так что
+// накопление многими вызовами остаётся амортизированно линейным. in и out должны быть разными
+// векторами
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation, typename OutAllocator,
+          typename OutGrowthPolicy, typename OutInstrumentation, typename Predicate>
+    requires std::is_arithmetic_v<T>
+void FilterInto(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &in,
+                Vector<T, OutAllocator, OutGrowthPolicy, OutInstrumentation> &out, Predicate pred) {
+    assert(static_cast<const void *>(&in) != static_cast<const void *>(&out));
+    const T *source = in.Data();
+    const size_t size = in.Size();
+    T *tail = out.ReserveTail(size).data();
+    out.CommitTail(detail::Dispatch<1>([&](auto, auto) __attribute__((always_inline)) {
+        return detail::FilterKernel(source, size, tail, pred);
+    }));
+}
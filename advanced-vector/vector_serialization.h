@@ -0,0 +1,317 @@
+#pragma once
+#include "mapped_vector.h"
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Двоичная сериализация Vector. Тривиально копируемые элементы пишутся одним блоком прямо из буфера
+// вектора и читаются прямо в него; для остальных типов поэлементно через Serializer<T>.
+//
+// Writer должен предоставлять Write(std::span<const std::byte>), а для записи несколькими кусками
+// за один системный вызов ещё и WriteV(std::span<const std::span<const std::byte>>).
+// Reader предоставляет Read(std::span<std::byte>), который заполняет буфер целиком или бросает, и
+// по возможности Remaining() — сколько байт осталось: тогда заголовок проверяется до выделения памяти
+
+// Заголовок перед элементами каждого вектора
+struct SerializedVectorHeader {
+    static constexpr std::uint32_t kMagic = 0x31535641;  // "AVS1"
+
+    std::uint32_t magic;
+    // sizeof(T) для тривиально копируемых T, для поэлементного формата 0
+    std::uint32_t element_size;
+    std::uint64_t count;
+};
+
+namespace detail {
+
+template <typename Writer>
+concept GatherWriter = requires(Writer &writer, std::span<const std::span<const std::byte>> parts) {
+    writer.WriteV(parts);
+};
+
+template <typename Writer>
+void WriteParts(Writer &writer, std::span<const std::span<const std::byte>> parts) {
+    if constexpr (GatherWriter<Writer>) {
+        writer.WriteV(parts);
+    } else {
+        for (auto part : parts) {
+            writer.Write(part);
+        }
+    }
+}
+
+// Reader, который знает, сколько байт осталось во входе
+template <typename Reader>
+concept SizedReader = requires(const Reader &reader) {
+    { reader.Remaining() } -> std::convertible_to<size_t>;
+};
+
+// Сколько байт элементов Deserialize читает за раз, если размер входа неизвестен
+inline constexpr size_t kDeserializeChunkBytes = size_t{1} << 20;
+
+template <typename T>
+consteval std::uint32_t SerializedElementSize() {
+    return std::is_trivially_copyable_v<T> ? sizeof(T) : 0;
+}
+
+}  // namespace detail
+
+// Точка настройки: специализация Serializer<T> со статическими Write(Writer &, const T &) и
+// Read(Reader &, T &) делает T сериализуемым, в том числе внутри Vector<T>. Основной шаблон
+// покрывает тривиально копируемые типы их байтовым представлением
+template <typename T>
+struct Serializer {
+    static_assert(std::is_trivially_copyable_v<T>, "specialize Serializer<T> for non-trivially copyable T");
+
+    template <typename Writer>
+    static void Write(Writer &writer, const T &value) {
+        writer.Write(std::as_bytes(std::span(&value, 1)));
+    }
+
+    template <typename Reader>
+    static void Read(Reader &reader, T &value) {
+        reader.Read(std::as_writable_bytes(std::span(&value, 1)));
+    }
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation>
+struct Serializer<Vector<T, Allocator, GrowthPolicy, Instrumentation>> {
+    using Container = Vector<T, Allocator, GrowthPolicy, Instrumentation>;
+
+    // Заголовок и элементы уходят одним WriteV, без промежуточного буфера
+    template <typename Writer>
+    static void Write(Writer &writer, const Container &vector) {
+        const SerializedVectorHeader header{SerializedVectorHeader::kMagic, detail::SerializedElementSize<T>(),
+                                            vector.Size()};
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            const std::span<const std::byte> parts[] = {
+                std::as_bytes(std::span(&header, 1)),
+                std::as_bytes(std::span(vector.Data(), vector.Size())),
+            };
+            detail::WriteParts(writer, parts);
+        } else {
+            writer.Write(std::as_bytes(std::span(&header, 1)));
+            for (const T &value : vector) {
+                Serializer<T>::Write(writer, value);
+            }
+        }
+    }
+
+    // Тривиальные элементы читаются прямо в буфер. Число элементов в заголовке не проверено, поэтому
+    // память не выделяется под него заранее: если Reader сообщает Remaining(), заголовок сначала
+    // сверяется с остатком входа, иначе элементы читаются кусками, и вектор растёт не быстрее, чем
+    // приходят данные. Поэлементный формат строит каждый элемент как T{} и заполняет его через
+    // Serializer<T>::Read, поэтому T должен создаваться по умолчанию.
+    // Если чтение бросит, vector останется пустым
+    template <typename Reader>
+    static void Read(Reader &reader, Container &vector) {
+        SerializedVectorHeader header;
+        reader.Read(std::as_writable_bytes(std::span(&header, 1)));
+        if (header.magic != SerializedVectorHeader::kMagic
+            || header.element_size != detail::SerializedElementSize<T>()) {
+            throw std::runtime_error("Deserialize: header does not match Vector<T>");
+        }
+        if constexpr (std::is_trivially_copyable_v<T> && detail::SizedReader<Reader>) {
+            if (header.count > reader.Remaining() / sizeof(T)) {
+                throw std::runtime_error("Deserialize: element count exceeds the input");
+            }
+        }
+
+        vector.Clear();
+        try {
+            ReadElements(reader, vector, header.count);
+        } catch (...) {
+            vector.Clear();
+            throw;
+        }
+    }
+
+private:
+    static constexpr size_t kChunk = std::max<size_t>(detail::kDeserializeChunkBytes / sizeof(T), 1);
+
+    template <typename Reader>
+    static void ReadElements(Reader &reader, Container &vector, std::uint64_t count) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if constexpr (detail::SizedReader<Reader>) {
+                // Остаток уже проверен: весь вектор читается за один раз
+                vector.ResizeAndOverwrite(count, [&reader](T *data, size_t n) {
+                    reader.Read(std::as_writable_bytes(std::span(data, n)));
+                    return n;
+                });
+            } else {
+                for (std::uint64_t left = count; left != 0;) {
+                    const size_t n = static_cast<size_t>(std::min<std::uint64_t>(left, kChunk));
+                    reader.Read(std::as_writable_bytes(vector.ReserveTail(n)));
+                    vector.CommitTail(n);
+                    left -= n;
+                }
+            }
+        } else {
+            static_assert(std::is_default_constructible_v<T>,
+                          "element-wise Deserialize builds each element as T{} before Serializer<T>::Read");
+            vector.Reserve(static_cast<size_t>(std::min<std::uint64_t>(count, kChunk)));
+            for (std::uint64_t i = 0; i < count; ++i) {
+                T value{};
+                Serializer<T>::Read(reader, value);
+                vector.EmplaceBack(std::move(value));
+            }
+        }
+    }
+};
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation, typename Writer>
+void Serialize(const Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector, Writer &writer) {
+    Serializer<Vector<T, Allocator, GrowthPolicy, Instrumentation>>::Write(writer, vector);
+}
+
+template <typename T, typename Allocator, typename GrowthPolicy, typename Instrumentation, typename Reader>
+void Deserialize(Vector<T, Allocator, GrowthPolicy, Instrumentation> &vector, Reader &reader) {
+    Serializer<Vector<T, Allocator, GrowthPolicy, Instrumentation>>::Read(reader, vector);
+}
+
+// Пишет в файловый дескриптор (файл, сокет, канал), дописывая после частичных записей
+class FdWriter {
+public:
+    explicit FdWriter(int fd) noexcept : fd_(fd) {
+    }
+
+    void Write(std::span<const std::byte> bytes) {
+        const std::span<const std::byte> parts[] = {bytes};
+        WriteV(parts);
+    }
+
+    void WriteV(std::span<const std::span<const std::byte>> parts) {
+        iovec iov[kMaxParts];
+        while (!parts.empty()) {
+            const size_t n = std::min(parts.size(), kMaxParts);
+            for (size_t i = 0; i < n; ++i) {
+                iov[i] = {const_cast<std::byte *>(parts[i].data()), parts[i].size()};
+            }
+            WriteAll(iov, n);
+            parts = parts.subspan(n);
+        }
+    }
+
+private:
+    static constexpr size_t kMaxParts = 16;
+
+    int fd_;
+
+    void WriteAll(iovec *iov, size_t n) {
+        while (n != 0) {
+            const ssize_t written = ::writev(fd_, iov, static_cast<int>(n));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "writev");
+            }
+            // Пропускаем целиком записанные куски и сдвигаем начало частично записанного
+            size_t left = written;
+            while (n != 0 && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                ++iov;
+                --n;
+            }
+            if (n != 0) {
+                iov->iov_base = static_cast<std::byte *>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+    }
+};
+
+// Читает из файлового дескриптора, дочитывая после частичных чтений
+class FdReader {
+public:
+    explicit FdReader(int fd) noexcept : fd_(fd) {
+    }
+
+    void Read(std::span<std::byte> bytes) {
+        while (!bytes.empty()) {
+            const ssize_t got = ::read(fd_, bytes.data(), bytes.size());
+            if (got < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (got == 0) {
+                throw std::runtime_error("Deserialize: unexpected end of stream");
+            }
+            bytes = bytes.subspan(got);
+        }
+    }
+
+private:
+    int fd_;
+};
+
+// Дописывает байты в конец вектора: сериализация в память, например перед отправкой по сети
+template <typename Allocator = std::allocator<std::byte>>
+class BufferWriter {
+public:
+    explicit BufferWriter(Vector<std::byte, Allocator> &buffer) noexcept : buffer_(&buffer) {
+    }
+
+    void Write(std::span<const std::byte> bytes) {
+        buffer_->Append(bytes);
+    }
+
+private:
+    Vector<std::byte, Allocator> *buffer_;
+};
+
+// Читает из непрерывного блока памяти
+class BufferReader {
+public:
+    explicit BufferReader(std::span<const std::byte> bytes) noexcept : bytes_(bytes) {
+    }
+
+    void Read(std::span<std::byte> bytes) {
+        if (bytes.size() > bytes_.size()) {
+            throw std::runtime_error("Deserialize: unexpected end of buffer");
+        }
+        std::memcpy(bytes.data(), bytes_.data(), bytes.size());
+        bytes_ = bytes_.subspan(bytes.size());
+    }
+
+    size_t Remaining() const noexcept {
+        return bytes_.size();
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+};
+
+// Отправляет MappedVector в out_fd в формате Serialize: заголовок обычной записью, элементы через
+// sendfile прямо из страничного кэша файла, не проходя через пространство пользователя
+template <typename T, std::uint32_t SchemaVersion, typename GrowthPolicy>
+void SendFile(const MappedVector<T, SchemaVersion, GrowthPolicy> &vector, int out_fd) {
+    const SerializedVectorHeader header{SerializedVectorHeader::kMagic, sizeof(T), vector.Size()};
+    FdWriter(out_fd).Write(std::as_bytes(std::span(&header, 1)));
+
+    off_t offset = vector.DataOffset();
+    size_t left = vector.Size() * sizeof(T);
+    while (left != 0) {
+        const ssize_t sent = ::sendfile(out_fd, vector.NativeHandle(), &offset, left);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "sendfile");
+        }
+        if (sent == 0) {
+            throw std::runtime_error("SendFile: file is shorter than the vector");
+        }
+        left -= sent;
+    }
+}
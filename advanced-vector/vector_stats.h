@@ -0,0 +1,161 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <typeinfo>
+
+// Счётчики событий одного семейства векторов. Все поля обновляются relaxed-атомиками: они нужны
+// для метрик, а не для синхронизации
+struct VectorStats {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> bytes_allocated{0};
+    std::atomic<std::uint64_t> relocated_bitwise{0};
+    std::atomic<std::uint64_t> relocated_moved{0};
+    std::atomic<std::uint64_t> relocated_copied{0};
+    std::atomic<std::uint64_t> shifted{0};
+    std::atomic<std::uint64_t> peak_capacity{0};
+    std::atomic<std::uint64_t> peak_size{0};
+
+    // Неатомарная копия счётчиков для выгрузки
+    struct Snapshot {
+        std::uint64_t allocations;
+        std::uint64_t bytes_allocated;
+        std::uint64_t relocated_bitwise;
+        std::uint64_t relocated_moved;
+        std::uint64_t relocated_copied;
+        std::uint64_t shifted;
+        std::uint64_t peak_capacity;
+        std::uint64_t peak_size;
+    };
+
+    Snapshot Read() const noexcept {
+        constexpr auto kOrder = std::memory_order_relaxed;
+        return {allocations.load(kOrder),       bytes_allocated.load(kOrder), relocated_bitwise.load(kOrder),
+                relocated_moved.load(kOrder),   relocated_copied.load(kOrder), shifted.load(kOrder),
+                peak_capacity.load(kOrder),     peak_size.load(kOrder)};
+    }
+
+    // Обнуляет счётчики событий, например в начале очередного интервала выгрузки. Пики
+    // сохраняются: это максимумы за всё время жизни, их сбрасывает только ResetPeaks
+    void Reset() noexcept {
+        for (auto *counter : {&allocations, &bytes_allocated, &relocated_bitwise, &relocated_moved,
+                              &relocated_copied, &shifted}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void ResetPeaks() noexcept {
+        peak_capacity.store(0, std::memory_order_relaxed);
+        peak_size.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    friend class VectorStatsRegistry;
+
+    // Узел реестра живёт в самих счётчиках, поэтому регистрация не выделяет памяти
+    std::string_view registry_name_;
+    const VectorStats *registry_next_ = nullptr;
+};
+
+// Все VectorStats, созданные CountingInstrumentation, под своими именами. Отсюда их забирает
+// экспорт в систему метрик. Реестр — интрусивный список без блокировок: регистрация вызывается из
+// noexcept-хуков вектора и не может ни выделять память, ни ждать мьютекс
+class VectorStatsRegistry {
+public:
+    static VectorStatsRegistry &Instance() noexcept {
+        static VectorStatsRegistry registry;
+        return registry;
+    }
+
+    // stats должен жить до конца программы и регистрироваться один раз
+    void Register(std::string_view name, VectorStats *stats) noexcept {
+        stats->registry_name_ = name;
+        const VectorStats *head = head_.load(std::memory_order_relaxed);
+        do {
+            stats->registry_next_ = head;
+        } while (!head_.compare_exchange_weak(head, stats, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Вызывает callback(name, snapshot) для каждого зарегистрированного семейства, начиная с
+    // последнего. Регистрации во время обхода допустимы: новые записи в него не попадут
+    template <typename Callback>
+    void ForEach(Callback &&callback) const {
+        for (const VectorStats *stats = head_.load(std::memory_order_acquire); stats != nullptr;
+             stats = stats->registry_next_) {
+            std::invoke(callback, stats->registry_name_, stats->Read());
+        }
+    }
+
+private:
+    std::atomic<const VectorStats *> head_{nullptr};
+};
+
+namespace detail {
+
+template <typename Tag>
+concept NamedStatsTag = requires {
+    { Tag::kName } -> std::convertible_to<std::string_view>;
+};
+
+inline void UpdateMax(std::atomic<std::uint64_t> &peak, std::uint64_t value) noexcept {
+    std::uint64_t current = peak.load(std::memory_order_relaxed);
+    while (current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace detail
+
+// Политика инструментирования, считающая события в VectorStats. Счётчики общие для всех векторов
+// с одним Tag: так на один тип контейнера в программе приходится одна запись в реестре.
+// Имя записи берётся из Tag::kName, а без него из typeid(Tag)
+//
+//   struct RequestQueueTag { static constexpr std::string_view kName = "request_queue"; };
+//   Vector<Request, std::allocator<Request>, DoublingGrowth, CountingInstrumentation<RequestQueueTag>> queue;
+template <typename Tag>
+struct CountingInstrumentation {
+    // Запись в реестре создаётся при первом событии
+    static VectorStats &Stats() noexcept {
+        static VectorStats &stats = []() noexcept -> VectorStats & {
+            static VectorStats instance;
+            if constexpr (detail::NamedStatsTag<Tag>) {
+                VectorStatsRegistry::Instance().Register(Tag::kName, &instance);
+            } else {
+                VectorStatsRegistry::Instance().Register(typeid(Tag).name(), &instance);
+            }
+            return instance;
+        }();
+        return stats;
+    }
+
+    static void OnAllocate(size_t bytes) noexcept {
+        auto &stats = Stats();
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        stats.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void OnRelocate(size_t count, RelocationKind kind) noexcept {
+        auto &stats = Stats();
+        switch (kind) {
+            case RelocationKind::kBitwise:
+                stats.relocated_bitwise.fetch_add(count, std::memory_order_relaxed);
+                break;
+            case RelocationKind::kMove:
+                stats.relocated_moved.fetch_add(count, std::memory_order_relaxed);
+                break;
+            case RelocationKind::kCopy:
+                stats.relocated_copied.fetch_add(count, std::memory_order_relaxed);
+                break;
+        }
+    }
+
+    static void OnShift(size_t count) noexcept {
+        Stats().shifted.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    static void OnSize(size_t size, size_t capacity) noexcept {
+        detail::UpdateMax(Stats().peak_size, size);
+        detail::UpdateMax(Stats().peak_capacity, capacity);
+    }
+};